@@ -1,9 +1,17 @@
 #version 330
 precision lowp float;
 
+#ifndef FOG
+#define FOG 0
+#endif
+
 in vec4 vColor;
 out vec4 FragColor;
 
 void main() {
 	FragColor = vColor;
+#if FOG
+	float depth = 1.0 / gl_FragCoord.w;
+	FragColor.rgb = mix(FragColor.rgb, vec3(0.2), smoothstep(4.0, 6.0, depth));
+#endif
 }
@@ -22,11 +22,19 @@
 #else
 
 // ============================================================================
-// Windows
+// Windows and Linux
 // ============================================================================
 
+// On Windows and Linux, we use generated headers instead of the system
+// headers, and load the function pointers ourselves.
+
+#if _WIN32
 #define GLAPI __stdcall
 #define GLIMPORT __declspec(dllimport)
+#else
+#define GLAPI
+#define GLIMPORT
+#endif
 
 struct __GLsync;
 
@@ -59,7 +67,7 @@ using GLDEBUGPROC = void(GLAPI *)(GLenum source, GLenum type, unsigned id,
 namespace demo {
 namespace gl_api {
 
-#if _WIN32
+#if !__APPLE__ && !GL_LAZY_PROCS
 
 // Load OpenGL function pointers.
 void LoadProcs();
@@ -71,6 +79,26 @@ inline void LoadProcs() {}
 
 #endif
 
+#if GL_LAZY_PROCS
+
+// Load an OpenGL function pointer and store it in FunctionPointers. Called by
+// the generated trampolines the first time each function is called.
+void *ResolveProc(int index);
+
+#endif
+
+#if GL_INTERPOSE
+
+// Install wrappers for every OpenGL function, such as the profiling or tracing
+// wrappers. The current function pointers are moved to RealFunctionPointers,
+// where the wrappers call them. Only one set of wrappers can be installed.
+void Interpose(void *const *wrappers);
+
+// Return true if wrappers have been installed with Interpose.
+bool IsInterposed();
+
+#endif
+
 // Check which extensions are loaded.
 void LoadExtensions();
 
@@ -3,34 +3,67 @@
 // SPDX-License-Identifier: MPL-2.0
 #include "gl.hpp"
 
+#include "hash.hpp"
+#include "log.hpp"
+
 #include <string_view>
-#include <unordered_map>
 
 namespace demo {
 namespace gl_api {
 
+namespace {
+
+// Get the index of an extension, or -1 if it is not one we use. The table is
+// a perfect hash, so only one name must be compared.
+int FindExtension(std::string_view name) {
+	const std::uint32_t nameHash = hash::Hash32(ExtensionHashSeed, name);
+	const int slot =
+		hash::PerfectHashSlot(nameHash, ExtensionDisplacements,
+	                          ExtensionBucketBits, ExtensionHashBits);
+	const int index = ExtensionHashTable[slot] - 1;
+	if (index < 0) {
+		return -1;
+	}
+	const char *const candidate = ExtensionNames + ExtensionNameOffsets[index];
+	return name == std::string_view{candidate} ? index : -1;
+}
+
+#if GL_INTERPOSE
+
+bool Interposed;
+
+#endif
+
+} // namespace
+
+#if GL_INTERPOSE
+
+void Interpose(void *const *wrappers) {
+	CHECK(!Interposed);
+	for (int i = 0; i < FunctionPointerCount; i++) {
+		RealFunctionPointers[i] = FunctionPointers[i];
+		FunctionPointers[i] = wrappers[i];
+	}
+	Interposed = true;
+}
+
+bool IsInterposed() {
+	return Interposed;
+}
+
+#endif
+
 void LoadExtensions() {
 	if constexpr (ExtensionCount > 0) {
-		// Create a map from extension names to indexes.
-		const char *namePtr = ExtensionNames;
-		std::unordered_map<std::string_view, int> extensions;
-		extensions.reserve(ExtensionCount);
-		for (int i = 0; i < ExtensionCount; i++) {
-			std::size_t length = std::strlen(namePtr);
-			extensions.insert({std::string_view(namePtr, length), i});
-			namePtr += length + 1;
-		}
-
 		// Look up the extensions present, and map them to indexes.
 		int extensionCount = 0;
 		glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
 		for (int i = 0; i < extensionCount; i++) {
 			const char *const ptr =
 				reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
-			const std::string_view name{ptr, std::strlen(ptr)};
-			const auto value = extensions.find(name);
-			if (value != extensions.end()) {
-				ExtensionAvailable[value->second] = true;
+			const int index = FindExtension(std::string_view{ptr});
+			if (index >= 0) {
+				ExtensionAvailable[index] = true;
 			}
 		}
 	}
@@ -8,24 +8,108 @@
 
 #if GL_KHR_debug
 
+#include <cstdint>
+#include <mutex>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace demo {
 namespace gl_debug {
 
 namespace {
 
+// Aggregated information about a debug message, identified by its source,
+// type, and ID.
+struct Message {
+	GLenum source;
+	GLenum type;
+	unsigned id;
+	log::Level level;
+	// Text of the first occurrence.
+	std::string text;
+	// Frame number of the first occurrence.
+	int firstFrame;
+	// Number of occurrences in total, and in the current frame.
+	unsigned long long total;
+	unsigned frameCount;
+};
+
+// The debug callback may be called from driver threads.
+std::mutex Lock;
+std::unordered_map<std::uint64_t, Message> Messages;
+int FrameNumber;
+// Number of performance messages this frame.
+unsigned PerformanceCount;
+
+std::uint64_t MessageKey(GLenum source, GLenum type, unsigned id) {
+	return (static_cast<std::uint64_t>(source & 0xffff) << 48) |
+	       (static_cast<std::uint64_t>(type & 0xffff) << 32) | id;
+}
+
+std::string_view SourceName(GLenum source) {
+	switch (source) {
+	case GL_DEBUG_SOURCE_API:
+		return "API";
+	case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+		return "WindowSystem";
+	case GL_DEBUG_SOURCE_SHADER_COMPILER:
+		return "ShaderCompiler";
+	case GL_DEBUG_SOURCE_THIRD_PARTY:
+		return "ThirdParty";
+	case GL_DEBUG_SOURCE_APPLICATION:
+		return "Application";
+	default:
+		return "Other";
+	}
+}
+
+std::string_view TypeName(GLenum type) {
+	switch (type) {
+	case GL_DEBUG_TYPE_ERROR:
+		return "Error";
+	case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+		return "DeprecatedBehavior";
+	case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+		return "UndefinedBehavior";
+	case GL_DEBUG_TYPE_PORTABILITY:
+		return "Portability";
+	case GL_DEBUG_TYPE_PERFORMANCE:
+		return "Performance";
+	case GL_DEBUG_TYPE_MARKER:
+		return "Marker";
+	case GL_DEBUG_TYPE_PUSH_GROUP:
+		return "PushGroup";
+	case GL_DEBUG_TYPE_POP_GROUP:
+		return "PopGroup";
+	default:
+		return "Other";
+	}
+}
+
+void AddMessageInfo(log::Record &record, const Message &message) {
+	record.Add("source", SourceName(message.source));
+	record.Add("type", TypeName(message.type));
+	record.Add("id", message.id);
+}
+
+// Return true if a repeated message should be logged again. Repeats are logged
+// at 10, 100, 1000, and so on, so they are visible without flooding the log.
+bool IsReportedRepeat(unsigned long long count) {
+	while (count >= 10 && count % 10 == 0) {
+		count /= 10;
+	}
+	return count == 1;
+}
+
 void GLAPI DebugCallback(GLenum source, GLenum type, GLenum id, GLenum severity,
                          int length, const char *message,
                          const void *userParam) {
-	(void)source;
-	(void)type;
-	(void)id;
 	(void)userParam;
 
-	std::string_view messageText = length >= 0
-	                                   ? std::string_view{message}
-	                                   : std::string_view(message, length);
+	const std::string_view messageText =
+		length >= 0 ? std::string_view(message, length)
+		            : std::string_view{message};
 
 	log::Level level;
 	switch (severity) {
@@ -44,9 +128,64 @@ void GLAPI DebugCallback(GLenum source, GLenum type, GLenum id, GLenum severity,
 		break;
 	}
 
-	log::Record{level, log::Location::Zero, "OpenGL",
-	            log::Attr("message", messageText)}
-		.Log();
+	const std::lock_guard<std::mutex> guard{Lock};
+	const auto [it, inserted] =
+		Messages.try_emplace(MessageKey(source, type, id));
+	Message &entry = it->second;
+	if (inserted) {
+		entry.source = source;
+		entry.type = type;
+		entry.id = id;
+		entry.level = level;
+		entry.text = messageText;
+		entry.firstFrame = FrameNumber;
+	}
+	entry.total++;
+	entry.frameCount++;
+
+	// Performance messages are reported at the end of the frame.
+	if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+		PerformanceCount++;
+		return;
+	}
+	if (inserted) {
+		log::Record record{level, log::Location::Zero, "OpenGL"};
+		record.Add("message", messageText);
+		AddMessageInfo(record, entry);
+		record.Log();
+	} else if (IsReportedRepeat(entry.total)) {
+		log::Record record{level, log::Location::Zero,
+		                   "OpenGL message repeated."};
+		AddMessageInfo(record, entry);
+		record.Add("count", entry.total);
+		record.Log();
+	}
+}
+
+// Log the performance messages for the frame.
+void ReportPerformance() {
+	LOG(Warn, "OpenGL performance messages.",
+	    log::Attr{"frame", FrameNumber},
+	    log::Attr{"count", PerformanceCount});
+	for (auto &[key, message] : Messages) {
+		if (message.type != GL_DEBUG_TYPE_PERFORMANCE ||
+		    message.frameCount == 0) {
+			continue;
+		}
+		log::Record record{message.level, log::Location::Zero,
+		                   "OpenGL performance message."};
+		AddMessageInfo(record, message);
+		record.Add("count", message.frameCount);
+		record.Add("total", message.total);
+		// The text is only shown the first time, since it is the same for
+		// every occurrence of the message.
+		if (message.firstFrame == FrameNumber) {
+			record.Add("message", message.text);
+		} else {
+			record.Add("first_frame", message.firstFrame);
+		}
+		record.Log();
+	}
 }
 
 } // namespace
@@ -63,6 +202,18 @@ void Init() {
 	glEnable(GL_DEBUG_OUTPUT);
 }
 
+void EndFrame() {
+	const std::lock_guard<std::mutex> guard{Lock};
+	if (PerformanceCount > 0) {
+		ReportPerformance();
+	}
+	for (auto &[key, message] : Messages) {
+		message.frameCount = 0;
+	}
+	PerformanceCount = 0;
+	FrameNumber++;
+}
+
 } // namespace gl_debug
 } // namespace demo
 
@@ -75,6 +226,8 @@ void Init() {
 	LOG(Debug, "KHR_debug not available.");
 }
 
+void EndFrame() {}
+
 } // namespace gl_debug
 } // namespace demo
 
@@ -6,8 +6,13 @@
 namespace demo {
 namespace gl_debug {
 
-// Initialize OpenGL debugging.
+// Initialize OpenGL debugging. Messages are logged when first seen, and
+// repeats are counted. Performance messages are collected and reported at the
+// end of each frame.
 void Init();
 
+// Report the performance messages for the current frame. Call once per frame.
+void EndFrame();
+
 } // namespace gl_debug
 } // namespace demo
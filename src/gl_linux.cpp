@@ -0,0 +1,235 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "gl.hpp"
+
+#include "hash.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <dlfcn.h>
+#include <link.h>
+
+namespace demo {
+namespace gl_api {
+
+namespace {
+
+#if GL_NAME_HASHES
+
+// Libraries which export the OpenGL core profile functions.
+constexpr const char *OpenGLLibraries[] = {"libOpenGL.so.0", "libGL.so.1"};
+
+// Get a pointer from the dynamic section. Depending on the platform, the
+// dynamic loader may or may not have already relocated it.
+const void *DynamicPointer(const link_map *map, ElfW(Addr) address) {
+	if (address < map->l_addr) {
+		address += map->l_addr;
+	}
+	return reinterpret_cast<const void *>(address);
+}
+
+// Count the symbols in a library, given its GNU hash table. The count is not
+// stored. It is one past the last symbol in the last chain.
+std::uint32_t GNUHashSymbolCount(const std::uint32_t *table) {
+	const std::uint32_t bucketCount = table[0];
+	const std::uint32_t symbolOffset = table[1];
+	const std::uint32_t bloomSize = table[2];
+	const std::uint32_t *const buckets =
+		table + 4 + bloomSize * (sizeof(ElfW(Addr)) / sizeof(std::uint32_t));
+	const std::uint32_t *const chains = buckets + bucketCount;
+	std::uint32_t last = 0;
+	for (std::uint32_t i = 0; i < bucketCount; i++) {
+		last = std::max(last, buckets[i]);
+	}
+	if (last < symbolOffset) {
+		return symbolOffset;
+	}
+	while ((chains[last - symbolOffset] & 1) == 0) {
+		last++;
+	}
+	return last + 1;
+}
+
+#endif
+
+// Signature of eglGetProcAddress and glXGetProcAddressARB. We look these up
+// with dlsym, so we don't need the EGL or GLX headers or libraries at build
+// time.
+using GetProcAddressProc = void *(*)(const char *name);
+using GetCurrentContextProc = void *(*)();
+
+// Find the function to load OpenGL functions for the current context. GLFW
+// creates the context with either EGL (Wayland) or GLX (X11), and has already
+// loaded the corresponding library.
+GetProcAddressProc FindGetProcAddress() {
+	void *const egl = dlopen("libEGL.so.1", RTLD_LAZY | RTLD_NOLOAD);
+	if (egl != nullptr) {
+		const auto getCurrentContext = reinterpret_cast<GetCurrentContextProc>(
+			dlsym(egl, "eglGetCurrentContext"));
+		if (getCurrentContext != nullptr && getCurrentContext() != nullptr) {
+			void *const proc = dlsym(egl, "eglGetProcAddress");
+			if (proc != nullptr) {
+				return reinterpret_cast<GetProcAddressProc>(proc);
+			}
+		}
+	}
+	for (const char *const name : {"libGLX.so.0", "libGL.so.1"}) {
+		void *const glx = dlopen(name, RTLD_LAZY | RTLD_LOCAL);
+		if (glx == nullptr) {
+			continue;
+		}
+		void *const proc = dlsym(glx, "glXGetProcAddressARB");
+		if (proc != nullptr) {
+			return reinterpret_cast<GetProcAddressProc>(proc);
+		}
+	}
+	FAIL("Could not find EGL or GLX.");
+}
+
+// Get the address of an OpenGL function. Returns null if the function is not
+// available. Note that GLX may return a non-null address for any name.
+void *GetProc(const char *name) {
+	static const GetProcAddressProc getProcAddress = FindGetProcAddress();
+	return getProcAddress(name);
+}
+
+#if !GL_LAZY_PROCS
+
+// Load the functions in FunctionNames, starting at the given index.
+void LoadProcsByName(int first) {
+	const char *namePtr = FunctionNames;
+	for (int i = first; i < FunctionPointerCount; i++) {
+		FunctionPointers[i] = GetProc(namePtr);
+		namePtr += std::strlen(namePtr) + 1;
+	}
+}
+
+#endif
+
+} // namespace
+
+#if GL_LAZY_PROCS
+
+void *ResolveProc(int index) {
+	const char *const name = FunctionNames + FunctionNameOffsets[index];
+	void *const proc = GetProc(name);
+	if (proc == nullptr) {
+		FAIL("Could not load OpenGL function.", log::Attr{"name", name});
+	}
+#if GL_INTERPOSE
+	// The wrapper stays installed and calls the real function.
+	if (IsInterposed()) {
+		RealFunctionPointers[index] = proc;
+		return proc;
+	}
+#endif
+	FunctionPointers[index] = proc;
+	return proc;
+}
+
+#elif GL_NAME_HASHES
+
+// Load the core function pointers by walking the export table of the OpenGL
+// library and matching each exported name against the table of name hashes.
+// This needs no names for those functions, and hashes each export once instead
+// of looking up each function. Extension functions are usually not exported,
+// so they are loaded by name.
+void LoadProcs() {
+	void *library = nullptr;
+	for (const char *const name : OpenGLLibraries) {
+		library = dlopen(name, RTLD_LAZY | RTLD_LOCAL);
+		if (library != nullptr) {
+			break;
+		}
+	}
+	if (library == nullptr) {
+		FAIL("Could not load OpenGL library.");
+	}
+	link_map *map;
+	if (dlinfo(library, RTLD_DI_LINKMAP, &map) != 0) {
+		FAIL("Could not get OpenGL library information.",
+		     log::Attr{"error", dlerror()});
+	}
+	const ElfW(Sym) *symbols = nullptr;
+	const char *strings = nullptr;
+	const std::uint32_t *hashTable = nullptr;
+	const std::uint32_t *gnuHashTable = nullptr;
+	for (const ElfW(Dyn) *dyn = map->l_ld; dyn->d_tag != DT_NULL; dyn++) {
+		const void *const ptr = DynamicPointer(map, dyn->d_un.d_ptr);
+		switch (dyn->d_tag) {
+		case DT_SYMTAB:
+			symbols = static_cast<const ElfW(Sym) *>(ptr);
+			break;
+		case DT_STRTAB:
+			strings = static_cast<const char *>(ptr);
+			break;
+		case DT_HASH:
+			hashTable = static_cast<const std::uint32_t *>(ptr);
+			break;
+		case DT_GNU_HASH:
+			gnuHashTable = static_cast<const std::uint32_t *>(ptr);
+			break;
+		}
+	}
+	if (symbols == nullptr || strings == nullptr ||
+	    (hashTable == nullptr && gnuHashTable == nullptr)) {
+		FAIL("Could not find OpenGL library exports.");
+	}
+	// The SysV hash table stores the symbol count as its chain count.
+	const std::uint32_t count = hashTable != nullptr
+	                                ? hashTable[1]
+	                                : GNUHashSymbolCount(gnuHashTable);
+	for (std::uint32_t i = 0; i < count; i++) {
+		const ElfW(Sym) &symbol = symbols[i];
+		// The low bits of st_info are the type, for both 32 and 64 bits.
+		if (symbol.st_shndx == SHN_UNDEF ||
+		    (symbol.st_info & 0xf) != STT_FUNC) {
+			continue;
+		}
+		const std::string_view name{strings + symbol.st_name};
+		if (!name.starts_with("gl")) {
+			continue;
+		}
+		const std::uint32_t nameHash = hash::Hash32(FunctionHashSeed, name);
+		const int slot =
+			hash::PerfectHashSlot(nameHash, FunctionDisplacements,
+		                          FunctionBucketBits, FunctionHashBits);
+		const int index = FunctionHashTable[slot] - 1;
+		if (index >= 0 && FunctionHashes[index] == nameHash) {
+			FunctionPointers[index] =
+				reinterpret_cast<void *>(map->l_addr + symbol.st_value);
+		}
+	}
+	// There are no names to fall back on, so these must all be present.
+	std::string missing;
+	for (int i = 0; i < FunctionHashCount; i++) {
+		if (FunctionPointers[i] == nullptr) {
+			if (!missing.empty()) {
+				missing.push_back(' ');
+			}
+			missing.append(std::to_string(i));
+		}
+	}
+	if (!missing.empty()) {
+		FAIL("OpenGL library is missing functions.",
+		     log::Attr{"indexes", missing});
+	}
+	LoadProcsByName(FunctionHashCount);
+}
+
+#else
+
+void LoadProcs() {
+	LoadProcsByName(0);
+}
+
+#endif
+
+} // namespace gl_api
+} // namespace demo
@@ -0,0 +1,141 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "gl_profile.hpp"
+
+#include "log.hpp"
+#include "var.hpp"
+
+#if GL_PROFILE
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace demo {
+namespace gl_profile {
+
+std::array<Counter, gl_api::FunctionPointerCount> Counters;
+bool TimeCalls;
+
+namespace {
+
+// Number of frames to average over for each report.
+constexpr int ReportFrames = 60;
+
+bool Enabled;
+int FrameCount;
+std::array<std::string_view, gl_api::FunctionPointerCount> FunctionNames;
+
+double ToMicroseconds(Clock::duration time) {
+	return std::chrono::duration<double, std::micro>(time).count();
+}
+
+// Log the totals, as averages per frame, and reset them.
+void Report() {
+	const double frames = FrameCount;
+	unsigned long long calls = 0;
+	Clock::duration time{};
+	for (const Counter &counter : Counters) {
+		calls += counter.calls;
+		time += counter.time;
+	}
+	log::Record record{log::Level::Info, LOG_LOCATION,
+	                   "OpenGL calls per frame."};
+	record.Add("frames", FrameCount);
+	record.Add("calls", static_cast<double>(calls) / frames);
+	if (TimeCalls) {
+		record.Add("time_us", ToMicroseconds(time) / frames);
+	}
+	record.Log();
+
+	// Most expensive functions first, or most frequent if calls are not
+	// timed.
+	std::array<int, gl_api::FunctionPointerCount> order;
+	for (int i = 0; i < gl_api::FunctionPointerCount; i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [](int x, int y) {
+		if (Counters[x].time != Counters[y].time) {
+			return Counters[x].time > Counters[y].time;
+		}
+		return Counters[x].calls > Counters[y].calls;
+	});
+	for (const int index : order) {
+		const Counter &counter = Counters[index];
+		if (counter.calls == 0) {
+			break;
+		}
+		log::Record record{log::Level::Debug, LOG_LOCATION,
+		                   "OpenGL function per frame."};
+		// One record per function, but only once per report.
+		record.SetUnlimited();
+		record.Add("function", FunctionNames[index]);
+		record.Add("calls", static_cast<double>(counter.calls) / frames);
+		if (TimeCalls) {
+			record.Add("time_us", ToMicroseconds(counter.time) / frames);
+		}
+		record.Log();
+	}
+
+	Counters = {};
+	FrameCount = 0;
+}
+
+} // namespace
+
+bool IsEnabled() {
+	return Enabled;
+}
+
+void Init() {
+	if (!var::GLProfile.get()) {
+		return;
+	}
+	if (gl_api::IsInterposed()) {
+		LOG(Warn, "OpenGL call profiling is not available while tracing.");
+		return;
+	}
+	const char *namePtr = gl_api::FunctionNames;
+	for (int i = 0; i < gl_api::FunctionPointerCount; i++) {
+		const std::size_t length = std::strlen(namePtr);
+		FunctionNames[i] = std::string_view{namePtr, length};
+		namePtr += length + 1;
+	}
+	gl_api::Interpose(gl_api::ProfileFunctionPointers);
+	TimeCalls = var::GLProfileTime.get();
+	Enabled = true;
+	LOG(Info, "OpenGL call profiling enabled.",
+	    log::Attr{"time", TimeCalls});
+}
+
+void EndFrame() {
+	if (!Enabled) {
+		return;
+	}
+	FrameCount++;
+	if (FrameCount >= ReportFrames) {
+		Report();
+	}
+}
+
+} // namespace gl_profile
+} // namespace demo
+
+#else
+
+namespace demo {
+namespace gl_profile {
+
+void Init() {
+	if (var::GLProfile.get()) {
+		LOG(Warn, "OpenGL call profiling is not available in this build.");
+	}
+}
+
+void EndFrame() {}
+
+} // namespace gl_profile
+} // namespace demo
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+// OpenGL call profiling. When the GLProfile variable is set, every OpenGL call
+// goes through a generated wrapper which counts calls, and optionally times
+// them. The totals are logged as averages per frame. When the variable is not
+// set, the wrappers are not installed and cost nothing.
+
+#include "gl.hpp"
+
+#if GL_PROFILE
+#include <array>
+#include <chrono>
+#endif
+
+namespace demo {
+namespace gl_profile {
+
+#if GL_PROFILE
+
+using Clock = std::chrono::steady_clock;
+
+// Totals for one OpenGL function.
+struct Counter {
+	unsigned long long calls;
+	Clock::duration time;
+};
+
+// Totals for each function, indexed like FunctionPointers.
+extern std::array<Counter, gl_api::FunctionPointerCount> Counters;
+
+// If true, time each call, not just count calls.
+extern bool TimeCalls;
+
+// Counts one call, and times it until this object is destroyed. Used by the
+// generated wrappers.
+class Scope {
+public:
+	explicit Scope(int index) : mIndex{index} {
+		Counters[index].calls++;
+		if (TimeCalls) {
+			mStart = Clock::now();
+		}
+	}
+	Scope(const Scope &) = delete;
+	Scope &operator=(const Scope &) = delete;
+	~Scope() {
+		if (TimeCalls) {
+			Counters[mIndex].time += Clock::now() - mStart;
+		}
+	}
+
+private:
+	int mIndex;
+	Clock::time_point mStart;
+};
+
+// Return true if the profiling wrappers are installed.
+bool IsEnabled();
+
+#endif
+
+// Install the profiling wrappers, if enabled by the GLProfile variable. Call
+// after loading the OpenGL function pointers.
+void Init();
+
+// Count a frame, and periodically log the totals. Call once per frame.
+void EndFrame();
+
+} // namespace gl_profile
+} // namespace demo
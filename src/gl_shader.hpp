@@ -4,16 +4,106 @@
 #pragma once
 
 #include "gl.hpp"
+#include "gl_shader_data.hpp"
+
+#include <array>
 
 namespace demo {
 namespace gl_shader {
 
-extern GLuint TriangleProgram;
-extern GLuint CubeProgram;
-extern GLint MVP;
+// Linked program objects, indexed by program ID, like Cube::Program.
+extern std::array<GLuint, ProgramCount> Programs;
+
+// Uniform locations, indexed by uniform ID, like Cube::uniform::MVP.
+extern std::array<GLint, UniformCount> Uniforms;
+
+// The last value uploaded to a uniform, so uploads which would not change the
+// value can be skipped. Large enough for a 4x4 matrix.
+struct UniformValue {
+	bool valid;
+	alignas(16) unsigned char data[64];
+};
+
+// Set the value of a uniform in the current program, by uniform ID. The
+// upload is skipped if the uniform already has the same value. Uniforms set
+// this way should not also be set with glUniform directly, or the cached value
+// will be wrong.
+void SetUniform1i(int uniformId, int value);
+void SetUniform1f(int uniformId, float value);
+void SetUniform2fv(int uniformId, const float *value);
+void SetUniform3fv(int uniformId, const float *value);
+void SetUniform4fv(int uniformId, const float *value);
+void SetUniformMatrix4fv(int uniformId, const float *value);
+
+#if !COMPO
+
+// Variants are only in the full build, since the competition build only uses
+// the base programs.
+
+// A variant of a shader program, compiled with specific feature values.
+struct Variant {
+	GLuint program;
+	int programId;
+	// Locations of the program's uniforms. Use uniform() to look up a
+	// location by uniform ID.
+	std::array<GLint, MaxProgramUniforms> uniforms;
+	// Last values uploaded to the program's uniforms, in the same order.
+	std::array<UniformValue, MaxProgramUniforms> values;
+
+	// Get the location of a uniform by uniform ID, like Cube::uniform::MVP.
+	GLint uniform(int uniformId) const {
+		return uniforms[uniformId - ProgramUniformOffsets[programId]];
+	}
+};
+
+// Get a variant of a shader program. The key combines feature values, like
+// Cube::feature::SHADOWS(1) | Cube::feature::SAMPLES(4). Each feature is
+// passed to the shaders as a #define, and shaders should provide defaults
+// with #ifndef for the base program, which has no defines.
+//
+// Variants are compiled on first use. Until the variant is ready, this returns
+// null, and the base program can be used instead. Do not keep the pointer
+// between frames, since variants are deleted when shaders are reloaded.
+Variant *GetVariant(int programId, VariantKey key);
 
-// Compile all OpenGL shader programs.
+// Compile variants requested by GetVariant, a few at a time. Call once per
+// frame, after Poll returns true.
+void UpdateVariants();
+
+// Set the value of a uniform in a program variant, which must be current.
+void SetUniform1i(Variant *variant, int uniformId, int value);
+void SetUniform1f(Variant *variant, int uniformId, float value);
+void SetUniform2fv(Variant *variant, int uniformId, const float *value);
+void SetUniform3fv(Variant *variant, int uniformId, const float *value);
+void SetUniform4fv(Variant *variant, int uniformId, const float *value);
+void SetUniformMatrix4fv(Variant *variant, int uniformId, const float *value);
+
+#endif
+
+// Start compiling all OpenGL shader programs. The programs may not be ready
+// when this returns. Call Poll until it returns true before using them.
 void Init();
 
+#if COMPO
+
+// The competition build compiles synchronously.
+inline bool Poll() {
+	return true;
+}
+
+#else
+
+// Check whether the shader programs have finished compiling, and finish
+// loading them if so. Returns true once all programs are ready to use. Call
+// once per frame. This does not block if KHR_parallel_shader_compile is
+// supported.
+bool Poll();
+
+// Reload any shaders which changed on disk. Call once per frame. This only
+// does anything if the shaders were loaded from the project directory.
+void Update();
+
+#endif
+
 } // namespace gl_shader
 } // namespace demo
@@ -0,0 +1,206 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "gl_shader_cache.hpp"
+
+#include "log.hpp"
+
+#if GL_ARB_get_program_binary
+
+#include "hash.hpp"
+#include "os_file.hpp"
+#include "timeline.hpp"
+#include "var.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace demo {
+namespace gl_shader {
+
+namespace {
+
+// Identifies program cache files and the version of the file format.
+constexpr std::uint32_t CacheMagic = 0x3142504c; // "LPB1"
+
+// Header for a program cache file. The program binary follows the header.
+struct CacheHeader {
+	std::uint32_t magic;
+	std::uint32_t format; // Binary format, from glGetProgramBinary.
+	std::uint32_t size;   // Size of program binary, in bytes.
+};
+
+bool CacheEnabled;
+os_string CacheDirectory;
+// Hash of the strings identifying the driver. Every key starts from this.
+hash::Hasher64 DriverHash;
+
+const char HexDigit[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                           '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+std::string_view GetString(GLenum name) {
+	const char *ptr = reinterpret_cast<const char *>(glGetString(name));
+	return ptr != nullptr ? std::string_view{ptr} : std::string_view{};
+}
+
+// Get the path to the cache file for the given key.
+os_string CachePath(std::uint64_t key) {
+	char name[20];
+	for (int i = 0; i < 16; i++) {
+		name[i] = HexDigit[(key >> ((15 - i) * 4)) & 15];
+	}
+	std::memcpy(name + 16, ".bin", 4);
+	os_string path{CacheDirectory};
+	AppendPath(&path, std::string_view{name, sizeof(name)});
+	return path;
+}
+
+} // namespace
+
+void InitCache() {
+	CacheEnabled = false;
+	const os_string_view directory = var::ShaderCache.get();
+	if (directory.empty()) {
+		return;
+	}
+	if (!gl_api::ARB_get_program_binary.available()) {
+		LOG(Info, "Program binaries not supported, shader cache disabled.");
+		return;
+	}
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	if (formatCount <= 0) {
+		LOG(Info, "No program binary formats, shader cache disabled.");
+		return;
+	}
+	CacheDirectory = directory;
+	if (!MakeDirectory(CacheDirectory)) {
+		return;
+	}
+	// Binaries are only valid for the driver that created them.
+	DriverHash = hash::Hasher64{};
+	DriverHash.Update(GetString(GL_VENDOR));
+	DriverHash.Update(GetString(GL_RENDERER));
+	DriverHash.Update(GetString(GL_VERSION));
+	CacheEnabled = true;
+}
+
+bool IsCacheEnabled() {
+	return CacheEnabled;
+}
+
+std::uint64_t CacheKey(std::span<const std::string_view> vertex,
+                       std::span<const std::string_view> fragment) {
+	hash::Hasher64 hasher = DriverHash;
+	for (const std::span<const std::string_view> shader : {vertex, fragment}) {
+		hasher.Update(static_cast<std::uint64_t>(shader.size()));
+		for (const std::string_view piece : shader) {
+			hasher.Update(piece);
+		}
+	}
+	return hasher.value();
+}
+
+bool LoadCachedProgram(GLuint program, std::uint64_t key) {
+	if (!CacheEnabled) {
+		return false;
+	}
+	std::vector<unsigned char> data;
+	if (!ReadFileIfExists(&data, CachePath(key))) {
+		return false;
+	}
+	CacheHeader header;
+	if (data.size() < sizeof(header)) {
+		LOG(Warn, "Invalid program cache file.");
+		return false;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != CacheMagic ||
+	    header.size != data.size() - sizeof(header)) {
+		LOG(Warn, "Invalid program cache file.");
+		return false;
+	}
+	glProgramBinary(program, header.format, data.data() + sizeof(header),
+	                static_cast<int>(header.size));
+	// The driver may reject binaries, for example, after it is updated. In
+	// that case, the program is compiled normally and the entry is replaced.
+	timeline::SyncPoint sync{"glGetProgramiv"};
+	GLint status;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	return status != 0;
+}
+
+void PrepareCachedProgram(GLuint program) {
+	if (CacheEnabled) {
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+		                    GL_TRUE);
+	}
+}
+
+void StoreCachedProgram(GLuint program, std::uint64_t key) {
+	if (!CacheEnabled) {
+		return;
+	}
+	GLint length = 0;
+	std::vector<unsigned char> data;
+	GLenum format = 0;
+	int written = 0;
+	{
+		timeline::SyncPoint sync{"glGetProgramBinary"};
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+		data.resize(sizeof(CacheHeader) + length);
+		glGetProgramBinary(program, length, &written, &format,
+		                   data.data() + sizeof(CacheHeader));
+	}
+	const CacheHeader header{CacheMagic, format,
+	                         static_cast<std::uint32_t>(written)};
+	std::memcpy(data.data(), &header, sizeof(header));
+	data.resize(sizeof(header) + written);
+	WriteFile(CachePath(key), data);
+}
+
+} // namespace gl_shader
+} // namespace demo
+
+#else
+
+namespace demo {
+namespace gl_shader {
+
+void InitCache() {
+	LOG(Debug, "ARB_get_program_binary not available.");
+}
+
+bool IsCacheEnabled() {
+	return false;
+}
+
+std::uint64_t CacheKey(std::span<const std::string_view> vertex,
+                       std::span<const std::string_view> fragment) {
+	(void)vertex;
+	(void)fragment;
+	return 0;
+}
+
+bool LoadCachedProgram(GLuint program, std::uint64_t key) {
+	(void)program;
+	(void)key;
+	return false;
+}
+
+void PrepareCachedProgram(GLuint program) {
+	(void)program;
+}
+
+void StoreCachedProgram(GLuint program, std::uint64_t key) {
+	(void)program;
+	(void)key;
+}
+
+} // namespace gl_shader
+} // namespace demo
+
+#endif
@@ -0,0 +1,40 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+// Persistent cache of linked program binaries, using glGetProgramBinary.
+
+#include "gl.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace demo {
+namespace gl_shader {
+
+// Initialize the program cache. The cache is disabled if the ShaderCache
+// variable is not set or if the driver does not support program binaries.
+void InitCache();
+
+// Return true if the program cache is enabled.
+bool IsCacheEnabled();
+
+// Get the cache key for a program, given the pieces of its vertex and fragment
+// shader source code. The key also depends on the driver.
+std::uint64_t CacheKey(std::span<const std::string_view> vertex,
+                       std::span<const std::string_view> fragment);
+
+// Load a program from the cache. Returns true if the program was found in the
+// cache and the driver accepted it.
+bool LoadCachedProgram(GLuint program, std::uint64_t key);
+
+// Prepare a program to be stored in the cache after it is linked.
+void PrepareCachedProgram(GLuint program);
+
+// Store a successfully linked program in the cache.
+void StoreCachedProgram(GLuint program, std::uint64_t key);
+
+} // namespace gl_shader
+} // namespace demo
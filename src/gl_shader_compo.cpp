@@ -11,13 +11,9 @@
 namespace demo {
 namespace gl_shader {
 
-GLuint TriangleProgram;
-GLuint CubeProgram;
-GLint MVP;
-
 // Compile the shaders that have been embedded into the program.
 void Init() {
-	std::array<ShaderSource, ShaderCount> source = GetEmbeddedShaderSource();
+	std::array<ShaderSource, ChunkCount> chunks = GetEmbeddedChunks();
 	std::array<GLuint, ShaderCount> shaders;
 	for (int i = 0; i < ShaderCount; i++) {
 		GLuint shader = glCreateShader(
@@ -26,24 +22,31 @@ void Init() {
 			FAIL("Could not create shader.");
 		}
 		shaders[i] = shader;
-		glShaderSource(shader, 1, &source[i].ptr, &source[i].size);
+		// Pass each chunk as a separate string, rather than concatenating.
+		std::array<const char *, MaxShaderChunks> ptr;
+		std::array<int, MaxShaderChunks> len;
+		const int start = ShaderChunkOffsets[i];
+		const int count = ShaderChunkOffsets[i + 1] - start;
+		for (int j = 0; j < count; j++) {
+			const ShaderSource &chunk = chunks[ShaderChunks[start + j]];
+			ptr[j] = chunk.ptr;
+			len[j] = chunk.size;
+		}
+		glShaderSource(shader, count, ptr.data(), len.data());
 		glCompileShader(shader);
 	}
-	std::array<GLuint, ProgramCount> programs;
 	for (int i = 0; i < ProgramCount; i++) {
 		GLuint program = glCreateProgram();
 		if (program == 0) {
 			FAIL("Could not create program.");
 		}
-		programs[i] = program;
+		Programs[i] = program;
 		const ProgramSpec &spec = ProgramSpecs[i];
 		glAttachShader(program, shaders[spec.vertex]);
 		glAttachShader(program, shaders[spec.fragment]);
 		glLinkProgram(program);
 	}
-	TriangleProgram = programs[0];
-	CubeProgram = programs[1];
-	MVP = glGetUniformLocation(CubeProgram, "MVP");
+	GetUniformLocations();
 }
 
 } // namespace gl_shader
@@ -3,27 +3,90 @@
 // SPDX-License-Identifier: MPL-2.0
 #include "gl_shader_data.hpp"
 
+#include "gl_shader.hpp"
+#include "timeline.hpp"
+
+#include <cstring>
+
 namespace demo {
 namespace gl_shader {
 
 extern const char ShaderText[];
 
-std::array<ShaderSource, ShaderCount> GetEmbeddedShaderSource() {
-	std::array<ShaderSource, ShaderCount> shaders;
+std::array<ShaderSource, ChunkCount> GetEmbeddedChunks() {
+	std::array<ShaderSource, ChunkCount> chunks;
 	const char *ptr = ShaderText;
-	for (auto &shader : shaders) {
+	for (auto &chunk : chunks) {
 		std::size_t length = std::strlen(ptr);
-		shader.ptr = ptr;
-		shader.size = static_cast<int>(length);
+		chunk.ptr = ptr;
+		chunk.size = static_cast<int>(length);
 		ptr += length + 1;
 	}
-	return shaders;
+	return chunks;
+}
+
+std::array<GLuint, ProgramCount> Programs;
+std::array<GLint, UniformCount> Uniforms;
+
+void GetUniformLocations() {
+	const char *name = UniformNames;
+	for (int uniformId = 0; uniformId < UniformCount; uniformId++) {
+		timeline::SyncPoint sync{"glGetUniformLocation"};
+		Uniforms[uniformId] =
+			glGetUniformLocation(Programs[UniformPrograms[uniformId]], name);
+		name += std::strlen(name) + 1;
+	}
+	ResetUniformValues();
+}
+
+#if !COMPO
+
+void GetProgramUniformLocations(GLuint program, int programId,
+                                GLint *locations) {
+	const char *name = UniformNames;
+	const int start = ProgramUniformOffsets[programId];
+	const int end = ProgramUniformOffsets[programId + 1];
+	for (int uniformId = 0; uniformId < end; uniformId++) {
+		if (uniformId >= start) {
+			locations[uniformId - start] = glGetUniformLocation(program, name);
+		}
+		name += std::strlen(name) + 1;
+	}
+}
+
+bool IsLinkComplete(GLuint program) {
+#if GL_KHR_parallel_shader_compile
+	if (gl_api::KHR_parallel_shader_compile.available()) {
+		GLint status;
+		glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &status);
+		return status != 0;
+	}
+#endif
+	(void)program;
+	return true;
+}
+
+void InsertAfterVersion(std::vector<std::string_view> *pieces,
+                        std::string_view text) {
+	for (auto piece = pieces->begin(); piece != pieces->end(); ++piece) {
+		const std::size_t version = piece->find("#version");
+		if (version == std::string_view::npos) {
+			continue;
+		}
+		std::size_t end = piece->find('\n', version);
+		end = end == std::string_view::npos ? piece->size() : end + 1;
+		const std::string_view rest = piece->substr(end);
+		*piece = piece->substr(0, end);
+		piece = pieces->insert(piece + 1, text);
+		if (!rest.empty()) {
+			pieces->insert(piece + 1, rest);
+		}
+		return;
+	}
+	pieces->insert(pieces->begin(), text);
 }
 
-extern const std::array<ProgramSpec, ProgramCount> ProgramSpecs = {{
-	{0, 2},
-	{1, 3},
-}};
+#endif
 
 } // namespace gl_shader
 } // namespace demo
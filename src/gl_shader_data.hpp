@@ -2,34 +2,113 @@
 // Licensed under the Mozilla Public License Version 2.0.
 // SPDX-License-Identifier: MPL-2.0
 #pragma once
+#include "gl.hpp"
+
 #include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
 
 namespace demo {
 namespace gl_shader {
 
-// FIXME: These are hard-coded. They should be generated.
-
-constexpr int ShaderCount = 4;
-constexpr int VertexShaderCount = 2;
-constexpr int ProgramCount = 2;
-
-// The source code for a shader.
+// A chunk of shader source code. Shaders are made from one or more chunks, so
+// code from included files is only stored once.
 struct ShaderSource {
 	const char *ptr;
 	int size;
 };
 
-// Get the source code for shaders embedded in the program.
-std::array<ShaderSource, ShaderCount> GetEmbeddedShaderSource();
-
 // Specification for a shader program.
 struct ProgramSpec {
 	int vertex;   // Index into shader array.
 	int fragment; // Index into shader array.
 };
 
-// Specifications for all programs.
-extern const std::array<ProgramSpec, ProgramCount> ProgramSpecs;
+// Key identifying a variant of a shader program. Each feature of the program
+// has its own bit field in the key.
+using VariantKey = std::uint32_t;
+
+// A feature define for a shader program, like Cube::feature::SHADOWS.
+struct Feature {
+	int shift; // Position of the bit field in the variant key.
+	int bits;  // Size of the bit field.
+
+	// Get the part of a variant key for the given feature value. Combine
+	// the parts for each feature with |.
+	constexpr VariantKey operator()(unsigned value) const {
+		return static_cast<VariantKey>(value) << shift;
+	}
+};
+
+} // namespace gl_shader
+} // namespace demo
+
+// Generated from shader/shaders.txt and the shader source code. Defines
+// ShaderCount, VertexShaderCount, ChunkCount, MaxShaderChunks, ProgramCount,
+// UniformCount, MaxProgramUniforms, FeatureCount, ShaderChunks,
+// ShaderChunkOffsets, ProgramSpecs, UniformPrograms, ProgramUniformOffsets,
+// ProgramFeatureOffsets, FeatureSpecs, and the program, uniform, feature, and
+// attribute IDs for each program.
+#if COMPO
+#include "gl_shaders_compo.hpp"
+#else
+#include "gl_shaders_full.hpp"
+#endif
+
+namespace demo {
+namespace gl_shader {
+
+// Filenames of all shaders, separated by null bytes.
+extern const char ShaderNames[];
+
+// Names of all uniforms, separated by null bytes, in order of uniform ID.
+extern const char UniformNames[];
+
+// Names of all features, separated by null bytes, in the same order as
+// FeatureSpecs.
+extern const char FeatureNames[];
+
+// Get the chunks of shader source code embedded in the program. The chunks for
+// each shader, in order, are listed in ShaderChunks, starting at the offset in
+// ShaderChunkOffsets.
+std::array<ShaderSource, ChunkCount> GetEmbeddedChunks();
+
+// Get the locations of all uniforms, once the programs are linked. This is
+// done by name, since OpenGL 3.3 does not have explicit uniform locations.
+// Also resets the cached uniform values.
+void GetUniformLocations();
+
+// Forget the cached values of all uniforms in the base programs. Called when
+// the programs are linked or replaced.
+void ResetUniformValues();
+
+#if !COMPO
+
+// Get the locations of the uniforms for one program, in order of uniform ID.
+void GetProgramUniformLocations(GLuint program, int programId,
+                                GLint *locations);
+
+// Return true if the program has finished linking, so querying its status
+// will not block. Without KHR_parallel_shader_compile, this is always true.
+bool IsLinkComplete(GLuint program);
+
+// Insert text after the #version line of a shader. The pieces of source code
+// are modified to point to the text, which must outlive them.
+void InsertAfterVersion(std::vector<std::string_view> *pieces,
+                        std::string_view text);
+
+// Create a shader object and start compiling it, with extra text inserted
+// after the #version line. Implemented by the shader loader, since it knows
+// where the source code comes from. Returns 0 if the source code is not
+// available.
+GLuint CompileShaderWithPrefix(int shaderId, std::string_view prefix);
+
+// Delete all program variants. Called when shaders are reloaded, so variants
+// are compiled again from the new source code.
+void ClearVariants();
+
+#endif
 
 } // namespace gl_shader
 } // namespace demo
@@ -3,13 +3,22 @@
 // SPDX-License-Identifier: MPL-2.0
 #include "gl_shader.hpp"
 
+#include "gl_shader_cache.hpp"
 #include "gl_shader_data.hpp"
 #include "log.hpp"
 #include "os_file.hpp"
+#include "os_watch.hpp"
+#include "timeline.hpp"
 #include "var.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace demo {
 namespace gl_shader {
@@ -22,52 +31,218 @@ namespace {
 
 struct Shader {
 	GLuint shader;
+	// True if the shader has been compiled. Shaders are not compiled if every
+	// program which uses them was loaded from the cache.
+	bool compiled;
 };
 
 std::array<Shader, ShaderCount> Shaders;
 
-// Compile a shader, given the source code for that shader.
-void CompileShader(int shaderId, std::string_view source) {
+// Get the OpenGL shader type for a shader.
+GLenum ShaderType(int shaderId) {
+	return shaderId < VertexShaderCount ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
+}
+
+// Filenames of all shaders, relative to the shader directory.
+const std::array<std::string_view, ShaderCount> ShaderFilenames = [] {
+	std::array<std::string_view, ShaderCount> filenames;
+	const char *ptr = ShaderNames;
+	for (std::string_view &filename : filenames) {
+		filename = ptr;
+		ptr += filename.size() + 1;
+	}
+	return filenames;
+}();
+
+// Source code for a shader, as a list of pieces. The pieces are passed to
+// glShaderSource separately, so code shared between shaders is not copied.
+using ShaderPieces = std::vector<std::string_view>;
+
+// Compile a shader object, given the source code for that shader.
+void CompileShaderObject(GLuint shader, const ShaderPieces &source) {
+	std::vector<const char *> ptr;
+	std::vector<int> len;
+	ptr.reserve(source.size());
+	len.reserve(source.size());
+	for (const std::string_view piece : source) {
+		ptr.push_back(piece.data());
+		len.push_back(static_cast<int>(piece.size()));
+	}
+	glShaderSource(shader, static_cast<GLsizei>(source.size()), ptr.data(),
+	               len.data());
+	glCompileShader(shader);
+}
+
+// Compile a shader, if it has not already been compiled.
+void CompileShader(int shaderId, const ShaderPieces &source) {
 	Shader &shader = Shaders[shaderId];
-	const char *ptr[1] = {source.data()};
-	const int len[1] = {static_cast<int>(source.size())};
-	glShaderSource(shader.shader, 1, ptr, len);
-	glCompileShader(shader.shader);
+	if (!shader.compiled) {
+		timeline::BeginPhase("Compile shader", ShaderFilenames[shaderId]);
+		CompileShaderObject(shader.shader, source);
+		shader.compiled = true;
+		timeline::EndPhase();
+	}
 }
 
-// Compile all shaders using the shader source code embedded in the exeuctable.
-void CompileEmbedded() {
-	std::array<ShaderSource, ShaderCount> sources = GetEmbeddedShaderSource();
+// Contents of shader files, by filename relative to the shader directory. Each
+// file is read once, even if it is included by several shaders. Pieces of
+// shader source code point into these strings.
+using SourceFiles = std::unordered_map<std::string, std::string>;
+
+// Source code for every shader.
+struct SourceSet {
+	std::array<ShaderPieces, ShaderCount> shaders;
+	SourceFiles files;
+};
+
+// Get the shader source code embedded in the exeuctable.
+void GetEmbeddedSource(SourceSet *sources) {
+	const std::array<ShaderSource, ChunkCount> chunks = GetEmbeddedChunks();
 	for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
-		const ShaderSource source = sources[shaderId];
-		const std::string_view sourceText{
-			source.ptr, static_cast<std::size_t>(source.size)};
-		CompileShader(shaderId, sourceText);
+		ShaderPieces &pieces = sources->shaders[shaderId];
+		pieces.clear();
+		for (int i = ShaderChunkOffsets[shaderId];
+		     i < ShaderChunkOffsets[shaderId + 1]; i++) {
+			const ShaderSource &chunk = chunks[ShaderChunks[i]];
+			pieces.emplace_back(chunk.ptr,
+			                    static_cast<std::size_t>(chunk.size));
+		}
 	}
 }
 
-// TODO: Don't hardcode this.
-const std::string_view ShaderFilenames[ShaderCount] = {
-	"triangle.vert",
-	"cube.vert",
-	"triangle.frag",
-	"cube.frag",
-};
+// Files that each shader was read from: the shader itself, followed by any
+// files it includes. A change to any of these files reloads the shader.
+std::array<std::vector<std::string>, ShaderCount> ShaderDependencies;
 
-// Compile shaders from the filesystem.
-void CompileFiles() {
-	std::vector<unsigned char> data;
-	std::string filename;
+// If a line is an include directive, get the filename and return true. The
+// filename is relative to the shader directory, like the shader build tool.
+bool ParseInclude(std::string_view line, std::string_view *filename) {
+	constexpr std::string_view space{" \t\r\n"};
+	const auto skipSpace = [&](std::string_view text) {
+		const std::size_t pos = text.find_first_not_of(space);
+		return pos == std::string_view::npos ? std::string_view{}
+		                                     : text.substr(pos);
+	};
+	line = skipSpace(line);
+	if (!line.starts_with('#')) {
+		return false;
+	}
+	line = skipSpace(line.substr(1));
+	if (!line.starts_with("include")) {
+		return false;
+	}
+	line = skipSpace(line.substr(7));
+	line = line.substr(0, line.find_last_not_of(space) + 1);
+	if (line.size() < 3 || line.front() != '"' || line.back() != '"') {
+		*filename = {};
+		return true;
+	}
+	*filename = line.substr(1, line.size() - 2);
+	return true;
+}
+
+// Read a shader file from the filesystem, splitting it at include directives
+// and reading the included files. Appends the pieces of source code. Files
+// already in the include list are skipped, so each is included at most once.
+bool ReadShaderPieces(SourceFiles *files, std::vector<std::string> *included,
+                      const std::string &filename, ShaderPieces *pieces) {
+	SourceFiles::iterator file = files->find(filename);
+	if (file == files->end()) {
+		std::vector<unsigned char> data;
+		std::string path{"shader/"};
+		path.append(filename);
+		if (!ReadFile(&data, path)) {
+			return false;
+		}
+		file = files
+		           ->emplace(filename,
+		                     std::string{reinterpret_cast<const char *>(
+		                                     data.data()),
+		                                 data.size()})
+		           .first;
+	}
+	const std::string_view text = file->second;
+	std::size_t start = 0;
+	for (std::size_t pos = 0; pos < text.size();) {
+		std::size_t end = text.find('\n', pos);
+		end = end == std::string_view::npos ? text.size() : end + 1;
+		std::string_view include;
+		if (ParseInclude(text.substr(pos, end - pos), &include)) {
+			if (include.empty()) {
+				LOG(Error, "Invalid include directive.",
+				    log::Attr{"filename", filename});
+				return false;
+			}
+			if (start < pos) {
+				pieces->push_back(text.substr(start, pos - start));
+			}
+			start = end;
+			if (std::find(included->begin(), included->end(), include) ==
+			    included->end()) {
+				std::string name{include};
+				included->push_back(name);
+				if (!ReadShaderPieces(files, included, name, pieces)) {
+					return false;
+				}
+			}
+		}
+		pos = end;
+	}
+	if (start < text.size()) {
+		pieces->push_back(text.substr(start));
+	}
+	return true;
+}
+
+// Read the source code for a shader and its included files from the
+// filesystem, and record which files it depends on.
+bool ReadShaderFile(SourceFiles *files, int shaderId, ShaderPieces *pieces) {
+	const std::string filename{ShaderFilenames[shaderId]};
+	std::vector<std::string> included{filename};
+	pieces->clear();
+	if (!ReadShaderPieces(files, &included, filename, pieces)) {
+		return false;
+	}
+	ShaderDependencies[shaderId] = std::move(included);
+	return true;
+}
+
+// Read the source code for all shaders from the filesystem.
+void ReadSourceFiles(SourceSet *sources) {
 	for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
-		filename.assign("shader/");
-		filename.append(ShaderFilenames[shaderId]);
-		if (!ReadFile(&data, filename)) {
-			FAIL("Could not read shader.", log::Attr{"filename", filename});
+		if (!ReadShaderFile(&sources->files, shaderId,
+		                    &sources->shaders[shaderId])) {
+			FAIL("Could not read shader.",
+			     log::Attr{"filename", ShaderFilenames[shaderId]});
+		}
+	}
+}
+
+// Return true if a shader depends on any of the files which changed.
+bool IsShaderChanged(int shaderId, const std::vector<std::string> &changed) {
+	const std::vector<std::string> &files = ShaderDependencies[shaderId];
+	for (const std::string &file : changed) {
+		if (file == ShaderFilenames[shaderId] ||
+		    std::find(files.begin(), files.end(), file) != files.end()) {
+			return true;
 		}
-		std::string_view sourceText{reinterpret_cast<const char *>(data.data()),
-		                            data.size()};
-		CompileShader(shaderId, sourceText);
 	}
+	return false;
+}
+
+// Log the error from a shader which failed to compile.
+void LogShaderError(int shaderId, GLuint shader) {
+	GLint length = 0;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+	std::string text;
+	if (length > 0) {
+		text.resize(length);
+		glGetShaderInfoLog(shader, length, &length, text.data());
+		text.resize(length);
+	}
+	LOG(Error, "Shader failed to compile.",
+	    log::Attr{"filename", ShaderFilenames[shaderId]},
+	    log::Attr{"log", text});
 }
 
 // ============================================================================
@@ -76,31 +251,293 @@ void CompileFiles() {
 
 struct Program {
 	GLuint program;
+	// True if the shaders are attached to the program, false if the program
+	// was loaded from the cache.
+	bool attached;
 };
 
-std::array<Program, ProgramCount> Programs;
+std::array<Program, ProgramCount> ProgramStates;
 
-// Link all shader programs.
-void LinkPrograms() {
-	// Link and then check status separately. This way, the driver can compile
-	// shaders in parallel.
+// Log the error from a program which failed to link.
+void LogProgramError(GLuint program) {
+	GLint length = 0;
+	glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+	std::string text;
+	if (length > 0) {
+		text.resize(length);
+		glGetProgramInfoLog(program, length, &length, text.data());
+		text.resize(length);
+	}
+	LOG(Error, "Shader program failed to link.", log::Attr{"log", text});
+}
+
+// Set the public variables for programs and uniforms.
+void UpdateProgramGlobals() {
 	for (int programId = 0; programId < ProgramCount; programId++) {
-		Program &program = Programs[programId];
+		Programs[programId] = ProgramStates[programId].program;
+	}
+	GetUniformLocations();
+}
+
+// Enable parallel shader compilation, if the driver supports it. If so,
+// linking happens on driver threads and completion can be polled without
+// blocking.
+void InitParallelCompile() {
+#if GL_KHR_parallel_shader_compile
+	if (gl_api::KHR_parallel_shader_compile.available()) {
+		// Let the driver choose how many threads to use.
+		glMaxShaderCompilerThreadsKHR(0xffffffff);
+	}
+#endif
+}
+
+// State for loading shader programs during startup.
+struct Loading {
+	bool ready;
+	std::array<std::uint64_t, ProgramCount> keys; // Cache keys.
+	int cachedCount;                              // Programs from the cache.
+};
+
+Loading ProgramLoading;
+
+// Start loading all shader programs, from the cache if possible, and otherwise
+// by compiling and linking the source code. Status is checked in
+// FinishLinkPrograms.
+void StartLinkPrograms(const SourceSet &sources) {
+	Loading &loading = ProgramLoading;
+	InitCache();
+	loading.ready = false;
+	loading.cachedCount = 0;
+	for (int programId = 0; programId < ProgramCount; programId++) {
+		Program &program = ProgramStates[programId];
+		const ProgramSpec &spec = ProgramSpecs[programId];
+		const ShaderPieces &vertex = sources.shaders[spec.vertex];
+		const ShaderPieces &fragment = sources.shaders[spec.fragment];
+		std::string detail{ShaderFilenames[spec.vertex]};
+		detail.append(", ");
+		detail.append(ShaderFilenames[spec.fragment]);
+		loading.keys[programId] = CacheKey(vertex, fragment);
+		timeline::BeginPhase("Load cached program", detail);
+		const bool cached =
+			LoadCachedProgram(program.program, loading.keys[programId]);
+		timeline::EndPhase();
+		if (cached) {
+			loading.cachedCount++;
+			continue;
+		}
+		CompileShader(spec.vertex, vertex);
+		CompileShader(spec.fragment, fragment);
+		timeline::BeginPhase("Link program", detail);
+		glAttachShader(program.program, Shaders[spec.vertex].shader);
+		glAttachShader(program.program, Shaders[spec.fragment].shader);
+		PrepareCachedProgram(program.program);
 		glLinkProgram(program.program);
+		program.attached = true;
+		timeline::EndPhase();
+	}
+}
+
+// Return true if every program started by StartLinkPrograms has finished
+// linking.
+bool IsLoadComplete() {
+	for (const Program &program : ProgramStates) {
+		if (program.attached && !IsLinkComplete(program.program)) {
+			return false;
+		}
 	}
+	return true;
+}
 
+// Check the status of all programs started by StartLinkPrograms, and store
+// them in the cache.
+void FinishLinkPrograms() {
+	Loading &loading = ProgramLoading;
+	timeline::BeginPhase("Finish linking programs");
 	for (int programId = 0; programId < ProgramCount; programId++) {
-		Program &program = Programs[programId];
+		Program &program = ProgramStates[programId];
+		if (!program.attached) {
+			continue;
+		}
 		GLint status;
-		glGetProgramiv(program.program, GL_LINK_STATUS, &status);
+		{
+			timeline::SyncPoint sync{"glGetProgramiv"};
+			glGetProgramiv(program.program, GL_LINK_STATUS, &status);
+		}
 		if (!status) {
+			LogProgramError(program.program);
 			FAIL("Shader program failed to link.");
 		}
+		StoreCachedProgram(program.program, loading.keys[programId]);
 	}
 
-	TriangleProgram = Programs[0].program;
-	CubeProgram = Programs[1].program;
-	MVP = glGetUniformLocation(CubeProgram, "MVP");
+	if (IsCacheEnabled()) {
+		LOG(Debug, "Loaded shader programs.",
+		    log::Attr{"cached", loading.cachedCount},
+		    log::Attr{"linked", ProgramCount - loading.cachedCount});
+	}
+	UpdateProgramGlobals();
+	loading.ready = true;
+	timeline::EndPhase();
+}
+
+// ============================================================================
+// Reloading
+// ============================================================================
+
+// Watches the shader directory for changes.
+DirectoryWatcher Watcher;
+
+// New shader and program objects for shaders which changed on disk. These
+// replace the existing objects once they have all compiled and linked
+// successfully.
+struct Reload {
+	bool active;
+	std::array<GLuint, ShaderCount> shaders;   // New shader, or 0.
+	std::array<GLuint, ProgramCount> programs; // New program, or 0.
+};
+
+Reload PendingReload;
+
+// Get the current shader object for a shader. If the shader was never compiled
+// because its programs came from the cache, compile it from the filesystem.
+GLuint CurrentShader(int shaderId) {
+	Shader &shader = Shaders[shaderId];
+	if (!shader.compiled) {
+		SourceFiles files;
+		ShaderPieces pieces;
+		if (ReadShaderFile(&files, shaderId, &pieces)) {
+			CompileShader(shaderId, pieces);
+		}
+	}
+	return shader.shader;
+}
+
+// Start compiling shaders which have changed, and linking the programs which
+// use them. Status is not checked until FinishReload, so the driver can do
+// this work while frames are drawn.
+void StartReload(const std::vector<std::string> &changed) {
+	Reload &reload = PendingReload;
+	reload.shaders.fill(0);
+	reload.programs.fill(0);
+
+	// Compile only the stages which changed, including stages which include a
+	// file which changed.
+	SourceFiles files;
+	ShaderPieces pieces;
+	bool hasShader = false;
+	for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
+		if (!IsShaderChanged(shaderId, changed)) {
+			continue;
+		}
+		if (!ReadShaderFile(&files, shaderId, &pieces)) {
+			// The OS error is logged by ReadFile. Editors may remove the file
+			// briefly while saving, and the next change reloads it.
+			std::string path{"shader/"};
+			path.append(ShaderFilenames[shaderId]);
+			LOG(Warn, "Could not read changed shader, keeping the old one.",
+			    log::Attr{"path", path});
+			continue;
+		}
+		const GLuint shader = glCreateShader(ShaderType(shaderId));
+		if (shader == 0) {
+			FAIL("Could not create shader.");
+		}
+		CompileShaderObject(shader, pieces);
+		reload.shaders[shaderId] = shader;
+		hasShader = true;
+	}
+	if (!hasShader) {
+		return;
+	}
+
+	// Relink the programs which use those stages.
+	for (int programId = 0; programId < ProgramCount; programId++) {
+		const ProgramSpec &spec = ProgramSpecs[programId];
+		const GLuint vertex = reload.shaders[spec.vertex];
+		const GLuint fragment = reload.shaders[spec.fragment];
+		if (vertex == 0 && fragment == 0) {
+			continue;
+		}
+		const GLuint program = glCreateProgram();
+		if (program == 0) {
+			FAIL("Could not create program.");
+		}
+		glAttachShader(program,
+		               vertex != 0 ? vertex : CurrentShader(spec.vertex));
+		glAttachShader(program,
+		               fragment != 0 ? fragment : CurrentShader(spec.fragment));
+		glLinkProgram(program);
+		reload.programs[programId] = program;
+	}
+	reload.active = true;
+}
+
+// Finish a reload started by StartReload. If every shader compiled and every
+// program linked, swap in all of the new objects at once. Otherwise, discard
+// them and keep the old ones.
+void FinishReload() {
+	Reload &reload = PendingReload;
+	reload.active = false;
+
+	bool ok = true;
+	for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
+		const GLuint shader = reload.shaders[shaderId];
+		if (shader != 0) {
+			GLint status;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+			if (!status) {
+				LogShaderError(shaderId, shader);
+				ok = false;
+			}
+		}
+	}
+	if (ok) {
+		for (const GLuint program : reload.programs) {
+			if (program != 0) {
+				GLint status;
+				glGetProgramiv(program, GL_LINK_STATUS, &status);
+				if (!status) {
+					LogProgramError(program);
+					ok = false;
+				}
+			}
+		}
+	}
+
+	if (!ok) {
+		LOG(Warn, "Shader reload failed, keeping old shaders.");
+		for (const GLuint program : reload.programs) {
+			if (program != 0) {
+				glDeleteProgram(program);
+			}
+		}
+		for (const GLuint shader : reload.shaders) {
+			if (shader != 0) {
+				glDeleteShader(shader);
+			}
+		}
+		return;
+	}
+
+	// Deleting the old programs first means that the old shaders are no longer
+	// attached to anything, and are freed when deleted.
+	for (int programId = 0; programId < ProgramCount; programId++) {
+		const GLuint program = reload.programs[programId];
+		if (program != 0) {
+			glDeleteProgram(ProgramStates[programId].program);
+			ProgramStates[programId] = Program{program, true};
+		}
+	}
+	for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
+		const GLuint shader = reload.shaders[shaderId];
+		if (shader != 0) {
+			glDeleteShader(Shaders[shaderId].shader);
+			Shaders[shaderId] = Shader{shader, true};
+		}
+	}
+	UpdateProgramGlobals();
+	ClearVariants();
+	LOG(Info, "Reloaded shaders.");
 }
 
 } // namespace
@@ -109,56 +546,104 @@ void LinkPrograms() {
 // Initialization
 // ============================================================================
 
-GLuint TriangleProgram;
-GLuint CubeProgram;
-GLint MVP;
-
 void Init() {
-	// Create shader objects.
+	// Create shader objects. These are compiled later, and only if needed.
 	for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
-		GLuint shader =
-			glCreateShader(shaderId < VertexShaderCount ? GL_VERTEX_SHADER
-		                                                : GL_FRAGMENT_SHADER);
+		GLuint shader = glCreateShader(ShaderType(shaderId));
 		if (shader == 0) {
 			FAIL("Could not create shader.");
 		}
-		Shaders[shaderId].shader = shader;
+		Shaders[shaderId] = Shader{shader, false};
 	}
 
-	// Create shader program objects and attach shaders.
+	// Create shader program objects.
 	for (int programId = 0; programId < ProgramCount; programId++) {
 		GLuint program = glCreateProgram();
 		if (program == 0) {
 			FAIL("Could not create program.");
 		}
-		Programs[programId].program = program;
-		const ProgramSpec &spec = ProgramSpecs[programId];
-		glAttachShader(program, Shaders[spec.vertex].shader);
-		glAttachShader(program, Shaders[spec.fragment].shader);
+		ProgramStates[programId] = Program{program, false};
 	}
 
 	// Figure out where shader source code is coming from.
-	os_string_view view = var::ProjectPath.get();
+	SourceSet sources;
+	if (var::ProjectPath.get().empty()) {
+		GetEmbeddedSource(&sources);
+	} else {
+		ReadSourceFiles(&sources);
+	}
+	InitParallelCompile();
+	StartLinkPrograms(sources);
+}
+
+GLuint CompileShaderWithPrefix(int shaderId, std::string_view prefix) {
+	SourceSet sources;
+	ShaderPieces &pieces = sources.shaders[shaderId];
+	if (var::ProjectPath.get().empty()) {
+		GetEmbeddedSource(&sources);
+	} else if (!ReadShaderFile(&sources.files, shaderId, &pieces)) {
+		return 0;
+	}
+	InsertAfterVersion(&pieces, prefix);
+	const GLuint shader = glCreateShader(ShaderType(shaderId));
+	if (shader == 0) {
+		FAIL("Could not create shader.");
+	}
+	CompileShaderObject(shader, pieces);
+	return shader;
+}
+
+bool Poll() {
+	if (ProgramLoading.ready) {
+		return true;
+	}
+	if (!IsLoadComplete()) {
+		return false;
+	}
+	FinishLinkPrograms();
+
 	if (var::ProjectPath.get().empty()) {
-		// No ProjectPath, so we only have the embedded shaders code. Compile
-		// and link, and then destroy the shader objects since we do not need
-		// them any more.
-		CompileEmbedded();
-		LinkPrograms();
+		// No ProjectPath, so we only have the embedded shaders code. Destroy
+		// the shader objects since we do not need them any more.
 		for (int programId = 0; programId < ProgramCount; programId++) {
-			const GLuint program = Programs[programId].program;
-			const ProgramSpec &spec = ProgramSpecs[programId];
-			glDetachShader(program, Shaders[spec.vertex].shader);
-			glDetachShader(program, Shaders[spec.fragment].shader);
+			Program &program = ProgramStates[programId];
+			if (program.attached) {
+				const ProgramSpec &spec = ProgramSpecs[programId];
+				glDetachShader(program.program, Shaders[spec.vertex].shader);
+				glDetachShader(program.program, Shaders[spec.fragment].shader);
+				program.attached = false;
+			}
 		}
 		for (int shaderId = 0; shaderId < ShaderCount; shaderId++) {
 			Shader &shader = Shaders[shaderId];
 			glDeleteShader(shader.shader);
-			shader.shader = 0;
+			shader = Shader{0, false};
 		}
 	} else {
-		CompileFiles();
-		LinkPrograms();
+		// Keep the shader objects, so programs can be relinked when only
+		// some of the shaders change.
+		if (Watcher.Init("shader")) {
+			LOG(Info, "Watching shaders for changes.");
+		}
+	}
+	return true;
+}
+
+void Update() {
+	if (PendingReload.active) {
+		for (const GLuint program : PendingReload.programs) {
+			if (program != 0 && !IsLinkComplete(program)) {
+				return;
+			}
+		}
+		FinishReload();
+	}
+	if (Watcher.IsActive()) {
+		std::vector<std::string> changed;
+		Watcher.Poll(&changed);
+		if (!changed.empty()) {
+			StartReload(changed);
+		}
 	}
 }
 
@@ -0,0 +1,132 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "gl_shader.hpp"
+
+#include "gl_shader_data.hpp"
+
+#include <cstring>
+
+namespace demo {
+namespace gl_shader {
+
+namespace {
+
+// Last values uploaded to uniforms in the base programs, by uniform ID.
+std::array<UniformValue, UniformCount> UniformValues;
+
+// Store a new value for a uniform. Returns false if the uniform already has
+// that value, so the upload can be skipped. The size is a constant, so the
+// comparison compiles to a few wide loads, even for a matrix.
+template <std::size_t Size>
+bool UpdateValue(UniformValue &cached, const void *value) {
+	static_assert(Size <= sizeof(cached.data));
+	if (cached.valid && std::memcmp(cached.data, value, Size) == 0) {
+		return false;
+	}
+	std::memcpy(cached.data, value, Size);
+	cached.valid = true;
+	return true;
+}
+
+#if !COMPO
+
+// Get the index of a uniform within a variant's uniform arrays.
+int VariantIndex(const Variant *variant, int uniformId) {
+	return uniformId - ProgramUniformOffsets[variant->programId];
+}
+
+#endif
+
+} // namespace
+
+void ResetUniformValues() {
+	for (UniformValue &value : UniformValues) {
+		value.valid = false;
+	}
+}
+
+void SetUniform1i(int uniformId, int value) {
+	if (UpdateValue<sizeof(int)>(UniformValues[uniformId], &value)) {
+		glUniform1i(Uniforms[uniformId], value);
+	}
+}
+
+void SetUniform1f(int uniformId, float value) {
+	if (UpdateValue<sizeof(float)>(UniformValues[uniformId], &value)) {
+		glUniform1f(Uniforms[uniformId], value);
+	}
+}
+
+void SetUniform2fv(int uniformId, const float *value) {
+	if (UpdateValue<sizeof(float) * 2>(UniformValues[uniformId], value)) {
+		glUniform2fv(Uniforms[uniformId], 1, value);
+	}
+}
+
+void SetUniform3fv(int uniformId, const float *value) {
+	if (UpdateValue<sizeof(float) * 3>(UniformValues[uniformId], value)) {
+		glUniform3fv(Uniforms[uniformId], 1, value);
+	}
+}
+
+void SetUniform4fv(int uniformId, const float *value) {
+	if (UpdateValue<sizeof(float) * 4>(UniformValues[uniformId], value)) {
+		glUniform4fv(Uniforms[uniformId], 1, value);
+	}
+}
+
+void SetUniformMatrix4fv(int uniformId, const float *value) {
+	if (UpdateValue<sizeof(float) * 16>(UniformValues[uniformId], value)) {
+		glUniformMatrix4fv(Uniforms[uniformId], 1, GL_FALSE, value);
+	}
+}
+
+#if !COMPO
+
+void SetUniform1i(Variant *variant, int uniformId, int value) {
+	const int index = VariantIndex(variant, uniformId);
+	if (UpdateValue<sizeof(int)>(variant->values[index], &value)) {
+		glUniform1i(variant->uniforms[index], value);
+	}
+}
+
+void SetUniform1f(Variant *variant, int uniformId, float value) {
+	const int index = VariantIndex(variant, uniformId);
+	if (UpdateValue<sizeof(float)>(variant->values[index], &value)) {
+		glUniform1f(variant->uniforms[index], value);
+	}
+}
+
+void SetUniform2fv(Variant *variant, int uniformId, const float *value) {
+	const int index = VariantIndex(variant, uniformId);
+	if (UpdateValue<sizeof(float) * 2>(variant->values[index], value)) {
+		glUniform2fv(variant->uniforms[index], 1, value);
+	}
+}
+
+void SetUniform3fv(Variant *variant, int uniformId, const float *value) {
+	const int index = VariantIndex(variant, uniformId);
+	if (UpdateValue<sizeof(float) * 3>(variant->values[index], value)) {
+		glUniform3fv(variant->uniforms[index], 1, value);
+	}
+}
+
+void SetUniform4fv(Variant *variant, int uniformId, const float *value) {
+	const int index = VariantIndex(variant, uniformId);
+	if (UpdateValue<sizeof(float) * 4>(variant->values[index], value)) {
+		glUniform4fv(variant->uniforms[index], 1, value);
+	}
+}
+
+void SetUniformMatrix4fv(Variant *variant, int uniformId, const float *value) {
+	const int index = VariantIndex(variant, uniformId);
+	if (UpdateValue<sizeof(float) * 16>(variant->values[index], value)) {
+		glUniformMatrix4fv(variant->uniforms[index], 1, GL_FALSE, value);
+	}
+}
+
+#endif
+
+} // namespace gl_shader
+} // namespace demo
@@ -0,0 +1,230 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "gl_shader.hpp"
+
+#include "gl_shader_data.hpp"
+#include "log.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace demo {
+namespace gl_shader {
+
+namespace {
+
+enum class VariantState : unsigned char {
+	Queued,  // Waiting in VariantQueue.
+	Linking, // Compiling and linking, in VariantLinking.
+	Ready,   // Ready to use.
+	Failed,  // Failed to compile or link. Not retried until reload.
+};
+
+struct VariantEntry {
+	VariantKey key;
+	VariantState state;
+	GLuint vertex;   // Vertex shader, while linking.
+	GLuint fragment; // Fragment shader, while linking.
+	Variant variant;
+};
+
+// All variants, in the order they were requested. This is a deque, so
+// pointers to variants stay valid when more are added.
+std::deque<VariantEntry> Variants;
+
+// Slot in the variant hash table. The key combines the program ID and the
+// variant key.
+struct Slot {
+	std::uint64_t key;
+	int index; // Index into Variants, or -1 if empty.
+};
+
+// Hash table for finding variants, using open addressing with linear probing.
+// The size is zero or a power of two, and is kept at most half full.
+std::vector<Slot> VariantTable;
+
+// Variants waiting to be compiled, oldest first.
+std::deque<int> VariantQueue;
+
+// Variants which are compiling and linking.
+std::vector<int> VariantLinking;
+
+// Find the slot for a key. Returns either the slot containing the key, or the
+// empty slot where it should be inserted.
+Slot &FindSlot(std::uint64_t key) {
+	const std::size_t mask = VariantTable.size() - 1;
+	// Fibonacci hashing: the high bits of the product are well-mixed.
+	std::size_t pos =
+		static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+	while (VariantTable[pos].index >= 0 && VariantTable[pos].key != key) {
+		pos = (pos + 1) & mask;
+	}
+	return VariantTable[pos];
+}
+
+// Double the size of the hash table.
+void GrowTable() {
+	std::vector<Slot> slots = std::move(VariantTable);
+	VariantTable.assign(slots.empty() ? 16 : slots.size() * 2, Slot{0, -1});
+	for (const Slot &slot : slots) {
+		if (slot.index >= 0) {
+			FindSlot(slot.key) = slot;
+		}
+	}
+}
+
+// Get the #define lines for a variant.
+std::string VariantDefines(int programId, VariantKey key) {
+	std::string text;
+	const char *name = FeatureNames;
+	const int start = ProgramFeatureOffsets[programId];
+	const int end = ProgramFeatureOffsets[programId + 1];
+	for (int featureId = 0; featureId < end; featureId++) {
+		if (featureId >= start) {
+			const Feature &feature = FeatureSpecs[featureId];
+			const VariantKey mask = ~VariantKey{0} >> (32 - feature.bits);
+			text.append("#define ");
+			text.append(name);
+			text.push_back(' ');
+			text.append(std::to_string((key >> feature.shift) & mask));
+			text.push_back('\n');
+		}
+		name += std::strlen(name) + 1;
+	}
+	return text;
+}
+
+// Start compiling and linking a queued variant.
+void StartVariant(int index) {
+	VariantEntry &entry = Variants[index];
+	const int programId = entry.variant.programId;
+	const std::string defines = VariantDefines(programId, entry.key);
+	const ProgramSpec &spec = ProgramSpecs[programId];
+	entry.vertex = CompileShaderWithPrefix(spec.vertex, defines);
+	entry.fragment = CompileShaderWithPrefix(spec.fragment, defines);
+	if (entry.vertex == 0 || entry.fragment == 0) {
+		glDeleteShader(entry.vertex);
+		glDeleteShader(entry.fragment);
+		entry.state = VariantState::Failed;
+		return;
+	}
+	const GLuint program = glCreateProgram();
+	if (program == 0) {
+		FAIL("Could not create program.");
+	}
+	glAttachShader(program, entry.vertex);
+	glAttachShader(program, entry.fragment);
+	glLinkProgram(program);
+	entry.variant.program = program;
+	entry.state = VariantState::Linking;
+	VariantLinking.push_back(index);
+}
+
+// Finish a variant once it has linked, and free its shader objects.
+void FinishVariant(VariantEntry &entry) {
+	const GLuint program = entry.variant.program;
+	glDetachShader(program, entry.vertex);
+	glDetachShader(program, entry.fragment);
+	glDeleteShader(entry.vertex);
+	glDeleteShader(entry.fragment);
+	entry.vertex = 0;
+	entry.fragment = 0;
+	GLint status;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (!status) {
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::string text;
+		if (length > 0) {
+			text.resize(length);
+			glGetProgramInfoLog(program, length, &length, text.data());
+			text.resize(length);
+		}
+		LOG(Error, "Shader program variant failed to link.",
+		    log::Attr{"program", entry.variant.programId},
+		    log::Attr{"key", entry.key}, log::Attr{"log", text});
+		glDeleteProgram(program);
+		entry.variant.program = 0;
+		entry.state = VariantState::Failed;
+		return;
+	}
+	GetProgramUniformLocations(program, entry.variant.programId,
+	                           entry.variant.uniforms.data());
+	entry.state = VariantState::Ready;
+}
+
+} // namespace
+
+Variant *GetVariant(int programId, VariantKey key) {
+	const std::uint64_t fullKey =
+		(static_cast<std::uint64_t>(programId) << 32) | key;
+	if (!VariantTable.empty()) {
+		const Slot &slot = FindSlot(fullKey);
+		if (slot.index >= 0) {
+			VariantEntry &entry = Variants[slot.index];
+			return entry.state == VariantState::Ready ? &entry.variant
+			                                          : nullptr;
+		}
+	}
+	// Only grow when inserting, so lookups never rehash.
+	if ((Variants.size() + 1) * 2 > VariantTable.size()) {
+		GrowTable();
+	}
+	Slot &slot = FindSlot(fullKey);
+	slot = Slot{fullKey, static_cast<int>(Variants.size())};
+	Variants.push_back(VariantEntry{key, VariantState::Queued, 0, 0,
+	                                Variant{0, programId, {}, {}}});
+	VariantQueue.push_back(slot.index);
+	return nullptr;
+}
+
+void UpdateVariants() {
+	for (std::size_t i = 0; i < VariantLinking.size();) {
+		VariantEntry &entry = Variants[VariantLinking[i]];
+		if (IsLinkComplete(entry.variant.program)) {
+			FinishVariant(entry);
+			VariantLinking[i] = VariantLinking.back();
+			VariantLinking.pop_back();
+		} else {
+			i++;
+		}
+	}
+
+	// Without KHR_parallel_shader_compile, compiling blocks, so only start
+	// one variant per frame. Otherwise, the driver compiles them in the
+	// background, and they can all be started at once.
+	bool parallel = false;
+#if GL_KHR_parallel_shader_compile
+	parallel = gl_api::KHR_parallel_shader_compile.available();
+#endif
+	while (!VariantQueue.empty()) {
+		StartVariant(VariantQueue.front());
+		VariantQueue.pop_front();
+		if (!parallel) {
+			break;
+		}
+	}
+}
+
+void ClearVariants() {
+	for (VariantEntry &entry : Variants) {
+		if (entry.state == VariantState::Linking) {
+			glDeleteShader(entry.vertex);
+			glDeleteShader(entry.fragment);
+		}
+		if (entry.variant.program != 0) {
+			glDeleteProgram(entry.variant.program);
+		}
+	}
+	Variants.clear();
+	VariantTable.clear();
+	VariantQueue.clear();
+	VariantLinking.clear();
+}
+
+} // namespace gl_shader
+} // namespace demo
@@ -0,0 +1,338 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "gl_trace.hpp"
+
+#include "log.hpp"
+#include "os_file.hpp"
+#include "var.hpp"
+
+#include <array>
+#include <string_view>
+
+namespace demo {
+namespace gl_trace {
+
+namespace {
+
+// Size of the scratch buffer for output arguments. This is large enough for
+// glReadPixels on a 4K RGBA framebuffer.
+constexpr std::size_t ScratchSize = 32 << 20;
+
+// Number of words needed for a blob with the given size, not counting the
+// size itself.
+std::size_t BlobWords(std::size_t size) {
+	return (size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+}
+
+} // namespace
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+Reader::Reader(std::span<const std::uint64_t> data) : mData{data}, mPos{0} {}
+
+std::uint64_t Reader::Next() {
+	if (mPos >= mData.size()) {
+		FAIL("OpenGL trace is truncated.");
+	}
+	return mData[mPos++];
+}
+
+const void *Reader::Data(std::size_t *size) {
+	const std::uint64_t blobSize = Next();
+	if (blobSize == NullData) {
+		if (size != nullptr) {
+			*size = 0;
+		}
+		return nullptr;
+	}
+	const std::size_t words = BlobWords(blobSize);
+	if (blobSize > mData.size() * sizeof(std::uint64_t) ||
+	    words > mData.size() - mPos) {
+		FAIL("OpenGL trace is truncated.");
+	}
+	const void *const ptr = mData.data() + mPos;
+	mPos += words;
+	if (size != nullptr) {
+		*size = blobSize;
+	}
+	return ptr;
+}
+
+const char *const *Reader::Strings() {
+	const std::uint64_t count = Next();
+	if (count > mData.size() - mPos) {
+		FAIL("OpenGL trace is truncated.");
+	}
+	mStrings.clear();
+	mLengths.clear();
+	for (std::uint64_t i = 0; i < count; i++) {
+		std::size_t size;
+		const char *const str = static_cast<const char *>(Data(&size));
+		if (str == nullptr || size == 0) {
+			FAIL("Invalid string in OpenGL trace.");
+		}
+		mStrings.push_back(str);
+		mLengths.push_back(static_cast<int>(size - 1));
+	}
+	return mStrings.data();
+}
+
+void *Reader::Scratch() {
+	if (mScratch.empty()) {
+		mScratch.resize(ScratchSize / sizeof(std::uint64_t));
+	}
+	return mScratch.data();
+}
+
+#if GL_TRACE
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+std::vector<std::uint64_t> Buffer;
+bool Recording;
+
+namespace {
+
+// Number of frames to record, if GLTraceFrames is not set.
+constexpr int DefaultFrames = 60;
+
+int FrameCount;
+int FrameLimit;
+std::array<bool, gl_api::FunctionPointerCount> Warned;
+
+// Append a blob to the trace.
+void WriteBlob(const void *ptr, std::size_t size) {
+	Buffer.push_back(size);
+	const std::size_t pos = Buffer.size();
+	Buffer.resize(pos + BlobWords(size));
+	if (size > 0) {
+		std::memcpy(Buffer.data() + pos, ptr, size);
+	}
+}
+
+std::string_view FunctionName(int index) {
+	const char *namePtr = gl_api::FunctionNames;
+	for (int i = 0; i < index; i++) {
+		namePtr += std::strlen(namePtr) + 1;
+	}
+	return std::string_view{namePtr};
+}
+
+// Get the number of bytes per pixel for pixel data, or 0 if unknown.
+int PixelSize(GLenum format, GLenum type) {
+	switch (type) {
+	case GL_UNSIGNED_BYTE_3_3_2:
+	case GL_UNSIGNED_BYTE_2_3_3_REV:
+		return 1;
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_5_6_5_REV:
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		return 2;
+	case GL_UNSIGNED_INT_8_8_8_8:
+	case GL_UNSIGNED_INT_8_8_8_8_REV:
+	case GL_UNSIGNED_INT_10_10_10_2:
+	case GL_UNSIGNED_INT_2_10_10_10_REV:
+	case GL_UNSIGNED_INT_24_8:
+	case GL_UNSIGNED_INT_10F_11F_11F_REV:
+	case GL_UNSIGNED_INT_5_9_9_9_REV:
+		return 4;
+	case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+		return 8;
+	}
+	int componentSize;
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+	case GL_BYTE:
+		componentSize = 1;
+		break;
+	case GL_UNSIGNED_SHORT:
+	case GL_SHORT:
+	case GL_HALF_FLOAT:
+		componentSize = 2;
+		break;
+	case GL_UNSIGNED_INT:
+	case GL_INT:
+	case GL_FLOAT:
+		componentSize = 4;
+		break;
+	default:
+		return 0;
+	}
+	int components;
+	switch (format) {
+	case GL_RED:
+	case GL_RED_INTEGER:
+	case GL_DEPTH_COMPONENT:
+	case GL_STENCIL_INDEX:
+		components = 1;
+		break;
+	case GL_RG:
+	case GL_RG_INTEGER:
+	case GL_DEPTH_STENCIL:
+		components = 2;
+		break;
+	case GL_RGB:
+	case GL_BGR:
+	case GL_RGB_INTEGER:
+	case GL_BGR_INTEGER:
+		components = 3;
+		break;
+	case GL_RGBA:
+	case GL_BGRA:
+	case GL_RGBA_INTEGER:
+	case GL_BGRA_INTEGER:
+		components = 4;
+		break;
+	default:
+		return 0;
+	}
+	return componentSize * components;
+}
+
+// Write the trace to the output file.
+void Finish() {
+	Recording = false;
+	const std::span<const unsigned char> data{
+		reinterpret_cast<const unsigned char *>(Buffer.data()),
+		Buffer.size() * sizeof(std::uint64_t)};
+	if (WriteFile(os_string{var::GLTrace.get()}, data)) {
+		LOG(Info, "Wrote OpenGL trace.", log::Attr{"frames", FrameCount},
+		    log::Attr{"bytes", static_cast<double>(data.size())});
+	}
+	Buffer = {};
+}
+
+} // namespace
+
+void Call::Data(const void *ptr, std::size_t size) {
+	if (!mRecording) {
+		return;
+	}
+	if (ptr == nullptr) {
+		Buffer.push_back(NullData);
+		return;
+	}
+	WriteBlob(ptr, size);
+}
+
+void Call::String(const char *str) {
+	if (!mRecording) {
+		return;
+	}
+	if (str == nullptr) {
+		Buffer.push_back(NullData);
+		return;
+	}
+	WriteBlob(str, std::strlen(str) + 1);
+}
+
+void Call::Strings(int count, const char *const *strings, const int *lengths) {
+	if (!mRecording) {
+		return;
+	}
+	Buffer.push_back(static_cast<std::uint64_t>(count));
+	for (int i = 0; i < count; i++) {
+		const char *const str = strings[i];
+		const std::size_t length = lengths != nullptr && lengths[i] >= 0
+		                               ? static_cast<std::size_t>(lengths[i])
+		                               : std::strlen(str);
+		// The blob includes a null terminator, which comes from zeroing the
+		// new words.
+		Buffer.push_back(length + 1);
+		const std::size_t pos = Buffer.size();
+		Buffer.resize(pos + BlobWords(length + 1));
+		std::memcpy(Buffer.data() + pos, str, length);
+	}
+}
+
+void Unsupported(int index) {
+	if (!Recording || Warned[index]) {
+		return;
+	}
+	Warned[index] = true;
+	LOG(Warn, "OpenGL function cannot be traced; trace will be incomplete.",
+	    log::Attr{"function", FunctionName(index)});
+}
+
+std::size_t ImageSize(int width, int height, int depth, GLenum format,
+                      GLenum type) {
+	if (width <= 0 || height <= 0 || depth <= 0) {
+		return 0;
+	}
+	const int pixelSize = PixelSize(format, type);
+	if (pixelSize == 0) {
+		FAIL("Cannot trace pixel data with unknown format.",
+		     log::Attr{"format", format}, log::Attr{"type", type});
+	}
+	// Rows are aligned to GL_UNPACK_ALIGNMENT, which defaults to 4. The last
+	// row is not padded.
+	const std::size_t rowSize =
+		static_cast<std::size_t>(width) * static_cast<std::size_t>(pixelSize);
+	const std::size_t rowStride = (rowSize + 3) & ~std::size_t{3};
+	const std::size_t rows =
+		static_cast<std::size_t>(height) * static_cast<std::size_t>(depth);
+	return (rows - 1) * rowStride + rowSize;
+}
+
+int ClearBufferCount(GLenum buffer) {
+	return buffer == GL_COLOR ? 4 : 1;
+}
+
+void Init() {
+	if (var::GLTrace.get().empty()) {
+		return;
+	}
+	if (gl_api::IsInterposed()) {
+		LOG(Warn, "OpenGL tracing is not available while profiling.");
+		return;
+	}
+	const int frames = var::GLTraceFrames.get();
+	FrameLimit = frames > 0 ? frames : DefaultFrames;
+
+	// Header.
+	const char *namePtr = gl_api::FunctionNames;
+	for (int i = 0; i < gl_api::FunctionPointerCount; i++) {
+		namePtr += std::strlen(namePtr) + 1;
+	}
+	Buffer.push_back(Magic);
+	Buffer.push_back(gl_api::FunctionPointerCount);
+	WriteBlob(gl_api::FunctionNames, namePtr - gl_api::FunctionNames);
+
+	gl_api::Interpose(gl_api::TraceFunctionPointers);
+	Recording = true;
+	LOG(Info, "OpenGL tracing enabled.", log::Attr{"frames", FrameLimit});
+}
+
+void EndFrame() {
+	if (!Recording) {
+		return;
+	}
+	Buffer.push_back(EndFrameMarker);
+	FrameCount++;
+	if (FrameCount >= FrameLimit) {
+		Finish();
+	}
+}
+
+#else
+
+void Init() {
+	if (!var::GLTrace.get().empty()) {
+		LOG(Warn, "OpenGL tracing is not available in this build.");
+	}
+}
+
+void EndFrame() {}
+
+#endif
+
+} // namespace gl_trace
+} // namespace demo
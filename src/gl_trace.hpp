@@ -0,0 +1,186 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+// OpenGL call tracing. When the GLTrace variable is set, every OpenGL call goes
+// through a generated wrapper which records the call and its arguments. After
+// GLTraceFrames frames, the trace is written to the GLTrace path. The Replay
+// program plays the trace back, so rendering can be benchmarked without the
+// rest of the program.
+//
+// Trace format: a sequence of 64-bit little-endian words. The header is the
+// magic number, the number of functions, and the function names as a blob.
+// Each call is the function index followed by its arguments, and each frame
+// ends with EndFrameMarker.
+//
+// - Values are stored in a word, zero-extended.
+//
+// - Blobs (data, strings) are a word with the size in bytes, followed by the
+//   data padded to a multiple of 8 bytes. Null pointers have the size
+//   NullData and no data.
+//
+// - String arrays are a word with the count, followed by a blob for each
+//   string. Strings include the null terminator.
+//
+// - Output arguments are not stored. The replayer passes a scratch buffer.
+//
+// Object names are not translated during replay. This relies on the driver
+// handing out the same names when the calls are made in the same order on a
+// fresh context, which is true of the drivers we use.
+
+#include "gl.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace demo {
+namespace gl_trace {
+
+// First word of a trace file: "LGT1".
+constexpr std::uint64_t Magic = 0x3154474c;
+
+// Marks the end of a frame, in place of a function index.
+constexpr std::uint64_t EndFrameMarker = 0xffff;
+
+// Size of a blob for a null pointer.
+constexpr std::uint64_t NullData = ~std::uint64_t{0};
+
+#if GL_TRACE
+
+// The trace being recorded.
+extern std::vector<std::uint64_t> Buffer;
+
+// If true, calls are being recorded.
+extern bool Recording;
+
+// Records one call. Used by the generated wrappers, which record the call
+// after making it, so recording time is not counted by timing wrappers.
+class Call {
+public:
+	explicit Call(int index) : mRecording{Recording} {
+		if (mRecording) {
+			Buffer.push_back(static_cast<std::uint64_t>(index));
+		}
+	}
+	Call(const Call &) = delete;
+	Call &operator=(const Call &) = delete;
+
+	template <typename T>
+	void Value(T value) {
+		static_assert(sizeof(T) <= sizeof(std::uint64_t));
+		if (mRecording) {
+			std::uint64_t word = 0;
+			std::memcpy(&word, &value, sizeof(T));
+			Buffer.push_back(word);
+		}
+	}
+
+	// Record data, given its size in bytes.
+	void Data(const void *ptr, std::size_t size);
+
+	// Record a null-terminated string.
+	void String(const char *str);
+
+	// Record an array of strings. If lengths is null, the strings are
+	// null-terminated. Otherwise, negative lengths mark null-terminated
+	// strings.
+	void Strings(int count, const char *const *strings, const int *lengths);
+
+private:
+	bool mRecording;
+};
+
+// Report that a function which cannot be traced was called. The trace will be
+// incomplete.
+void Unsupported(int index);
+
+// Get the size of pixel data passed to glTexImage and glTexSubImage, in bytes.
+// Assumes the default unpack parameters.
+std::size_t ImageSize(int width, int height, int depth, GLenum format,
+                      GLenum type);
+
+// Get the number of values passed to glClearBuffer.
+int ClearBufferCount(GLenum buffer);
+
+#endif
+
+// Reads calls from a trace, for replay.
+class Reader {
+public:
+	explicit Reader(std::span<const std::uint64_t> data);
+	Reader(const Reader &) = delete;
+	Reader &operator=(const Reader &) = delete;
+
+	// Position in the trace, in words.
+	std::size_t position() const { return mPos; }
+	void set_position(std::size_t pos) { mPos = pos; }
+	bool AtEnd() const { return mPos == mData.size(); }
+
+	// Read the next word.
+	std::uint64_t Next();
+
+	template <typename T>
+	T Value() {
+		static_assert(sizeof(T) <= sizeof(std::uint64_t));
+		const std::uint64_t word = Next();
+		T value;
+		std::memcpy(&value, &word, sizeof(T));
+		return value;
+	}
+
+	// Read a blob. The result points into the trace, and is valid for as
+	// long as the trace. Returns null for null pointers.
+	const void *Data() { return Data(nullptr); }
+	const void *Data(std::size_t *size);
+
+	const char *String() { return static_cast<const char *>(Data()); }
+
+	// Read an array of strings. The result is valid until the next call to
+	// Strings.
+	const char *const *Strings();
+
+	// Get the lengths of the strings read by the last call to Strings, not
+	// counting the null terminators.
+	const int *StringLengths() const { return mLengths.data(); }
+
+	// Get a buffer for output arguments.
+	void *Scratch();
+
+private:
+	std::span<const std::uint64_t> mData;
+	std::size_t mPos;
+	std::vector<const char *> mStrings;
+	std::vector<int> mLengths;
+	std::vector<std::uint64_t> mScratch;
+};
+
+// Function which reads the arguments for one call from a trace and makes the
+// call.
+using ReplayFunction = void (*)(Reader &reader);
+
+// Start tracing, if enabled by the GLTrace variable. Call after loading the
+// OpenGL function pointers.
+void Init();
+
+// Count a frame, and write the trace once enough frames are recorded. Call
+// once per frame.
+void EndFrame();
+
+} // namespace gl_trace
+
+namespace gl_api {
+
+#if GL_TRACE
+
+// Functions which replay calls from a trace, indexed like FunctionPointers.
+// Functions which cannot be traced are null.
+extern const gl_trace::ReplayFunction ReplayFunctions[FunctionPointerCount];
+
+#endif
+
+} // namespace gl_api
+} // namespace demo
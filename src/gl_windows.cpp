@@ -3,19 +3,64 @@
 // SPDX-License-Identifier: MPL-2.0
 #include "gl.hpp"
 
+#include "log.hpp"
 #include "os_windows.hpp"
 
+#include <cstdint>
+#include <cstring>
+
 namespace demo {
 namespace gl_api {
 
+namespace {
+
+// Get the address of an OpenGL function. Returns null if the function is not
+// available. Some drivers return small integers instead of null on failure.
+void *GetProc(const char *name) {
+	PROC proc = wglGetProcAddress(name);
+	const std::intptr_t value = reinterpret_cast<std::intptr_t>(proc);
+	if (value >= -1 && value <= 3) {
+		// OpenGL 1.1 functions are not returned by wglGetProcAddress, only
+		// exported from opengl32.dll. They are loaded at runtime when calls
+		// are profiled.
+		static const HMODULE module = GetModuleHandleW(L"opengl32.dll");
+		proc = module != nullptr ? GetProcAddress(module, name) : nullptr;
+	}
+	return reinterpret_cast<void *>(proc);
+}
+
+} // namespace
+
+#if GL_LAZY_PROCS
+
+void *ResolveProc(int index) {
+	const char *const name = FunctionNames + FunctionNameOffsets[index];
+	void *const proc = GetProc(name);
+	if (proc == nullptr) {
+		FAIL("Could not load OpenGL function.", log::Attr{"name", name});
+	}
+#if GL_INTERPOSE
+	// The wrapper stays installed and calls the real function.
+	if (IsInterposed()) {
+		RealFunctionPointers[index] = proc;
+		return proc;
+	}
+#endif
+	FunctionPointers[index] = proc;
+	return proc;
+}
+
+#else
+
 void LoadProcs() {
 	const char *namePtr = FunctionNames;
 	for (int i = 0; i < FunctionPointerCount; i++) {
-		PROC proc = wglGetProcAddress(namePtr);
-		FunctionPointers[i] = static_cast<void *>(proc);
+		FunctionPointers[i] = GetProc(namePtr);
 		namePtr += std::strlen(namePtr) + 1;
 	}
 }
 
+#endif
+
 } // namespace gl_api
 } // namespace demo
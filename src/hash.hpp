@@ -0,0 +1,65 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace demo {
+namespace hash {
+
+// Incremental 64-bit FNV-1a hash. This is not a cryptographic hash.
+class Hasher64 {
+public:
+	constexpr Hasher64() : mState{0xcbf29ce484222325ull} {}
+
+	// Add an integer to the hash.
+	constexpr void Update(std::uint64_t value) {
+		for (int i = 0; i < 8; i++) {
+			AddByte(static_cast<unsigned char>(value >> (i * 8)));
+		}
+	}
+
+	// Add a string to the hash. The length is included, so the boundaries
+	// between strings affect the hash.
+	constexpr void Update(std::string_view value) {
+		Update(static_cast<std::uint64_t>(value.size()));
+		for (const char c : value) {
+			AddByte(static_cast<unsigned char>(c));
+		}
+	}
+
+	constexpr std::uint64_t value() const { return mState; }
+
+private:
+	constexpr void AddByte(unsigned char c) {
+		mState = (mState ^ c) * 0x100000001b3ull;
+	}
+
+	std::uint64_t mState;
+};
+
+// 32-bit FNV-1a hash of a string, starting from the given seed instead of the
+// usual offset basis. Used by the lookup tables generated by gl-emit, and must
+// match tools/src/gl/hash.rs.
+constexpr std::uint32_t Hash32(std::uint32_t seed, std::string_view value) {
+	std::uint32_t state = seed;
+	for (const char c : value) {
+		state = (state ^ static_cast<unsigned char>(c)) * 0x01000193u;
+	}
+	return state;
+}
+
+// Get the slot for a hash in a perfect hash table generated by gl-emit. The
+// top bits of the hash select a displacement, which is mixed into the hash.
+constexpr int PerfectHashSlot(std::uint32_t hash,
+                              const unsigned *displacements, int bucketBits,
+                              int tableBits) {
+	const std::uint32_t displacement = displacements[hash >> (32 - bucketBits)];
+	return static_cast<int>(((hash ^ displacement) * 0x9e3779b9u) >>
+	                        (32 - tableBits));
+}
+
+} // namespace hash
+} // namespace demo
@@ -39,9 +39,16 @@
 /// LOG(Info, "Message.", Attr("x", x));
 /// </code>
 /// </example>
+/// <remarks>
+/// The level is checked first. If the level is not enabled, the attributes
+/// are not evaluated.
+/// </remarks>
 #define LOG(level, ...) \
-	::demo::log::Record{::demo::log::Level::level, LOG_LOCATION, __VA_ARGS__} \
-		.Log()
+	(void)(!::demo::log::IsEnabled(::demo::log::Level::level) || \
+	       (::demo::log::Record{::demo::log::Level::level, LOG_LOCATION, \
+	                            __VA_ARGS__} \
+	            .Log(), \
+	        0))
 
 /// <summary>
 /// Check that a condition is true. If not, show an error message and exit the
@@ -0,0 +1,422 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "log_internal.hpp"
+
+#include "log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// Asynchronous logging. Records are serialized into fixed-size slots in a
+// bounded ring, and a writer thread formats and writes them. The ring is the
+// bounded MPMC queue by Dmitry Vyukov, used with a single consumer. Producers
+// never block or make system calls: if the ring is full, the record is dropped
+// and counted. The writer thread polls, so producers don't need to wake it;
+// only Flush and Stop do.
+
+namespace demo {
+namespace log {
+
+namespace {
+
+// Size of a slot, in bytes. Longer records are truncated.
+constexpr std::size_t SlotSize = 1024;
+
+// Number of slots in the ring. Must be a power of two.
+constexpr std::size_t SlotCount = 256;
+
+// Maximum number of attributes in a record.
+constexpr int MaxAttributes = 32;
+
+// How long the writer thread sleeps when the ring is empty.
+constexpr std::chrono::milliseconds PollInterval{2};
+
+// How long to wait for the writer thread to empty the ring before failing.
+constexpr std::chrono::seconds FlushTimeout{1};
+
+struct Slot {
+	// Position this slot is ready for. Equal to the enqueue position when the
+	// slot is free, and to the enqueue position plus one when it is full.
+	std::atomic<std::size_t> sequence;
+	unsigned char data[SlotSize];
+};
+
+// Header for a serialized record. The location, message, and attribute names
+// refer to string literals, so they are stored as-is.
+struct RecordHeader {
+	Level level;
+	Location location;
+	std::string_view message;
+	std::uint8_t attributeCount;
+	bool unlimited;
+};
+
+// Header for a serialized attribute. Followed by the value if it is a string.
+struct AttributeHeader {
+	Kind kind;
+	std::string_view name;
+	union {
+		long long intValue;
+		unsigned long long uintValue;
+		double floatValue;
+		bool boolValue;
+		// Size of a string value, in bytes.
+		std::size_t stringSize;
+	};
+};
+
+// Writes serialized data into a slot.
+class SlotWriter {
+public:
+	explicit SlotWriter(unsigned char *data) : mData{data}, mPos{0} {}
+
+	std::size_t available() const { return SlotSize - mPos; }
+
+	// Reserve space for an object and return a pointer to it, or null if
+	// there is no room.
+	template <typename T>
+	T *Reserve() {
+		Align(alignof(T));
+		if (available() < sizeof(T)) {
+			return nullptr;
+		}
+		T *const ptr = new (mData + mPos) T{};
+		mPos += sizeof(T);
+		return ptr;
+	}
+
+	// Write as much of a string as fits, and return the number of bytes
+	// written.
+	std::size_t Write(const void *ptr, std::size_t size, std::size_t align) {
+		Align(align);
+		size = std::min(size, available()) / align * align;
+		std::memcpy(mData + mPos, ptr, size);
+		mPos += size;
+		return size;
+	}
+
+private:
+	void Align(std::size_t align) {
+		mPos = std::min((mPos + align - 1) & ~(align - 1), SlotSize);
+	}
+
+	unsigned char *mData;
+	std::size_t mPos;
+};
+
+// Reads serialized data from a slot.
+class SlotReader {
+public:
+	explicit SlotReader(const unsigned char *data) : mData{data}, mPos{0} {}
+
+	template <typename T>
+	const T &Read() {
+		Align(alignof(T));
+		const T &value = *reinterpret_cast<const T *>(mData + mPos);
+		mPos += sizeof(T);
+		return value;
+	}
+
+	template <typename Char>
+	std::basic_string_view<Char> ReadString(std::size_t size) {
+		Align(alignof(Char));
+		const Char *const ptr = reinterpret_cast<const Char *>(mData + mPos);
+		mPos += size;
+		return {ptr, size / sizeof(Char)};
+	}
+
+private:
+	void Align(std::size_t align) { mPos = (mPos + align - 1) & ~(align - 1); }
+
+	const unsigned char *mData;
+	std::size_t mPos;
+};
+
+// Serialize a record into a slot. Strings which don't fit are truncated, and
+// attributes which don't fit are dropped.
+void Serialize(unsigned char *data, const Record &record) {
+	SlotWriter out{data};
+	RecordHeader *const header = out.Reserve<RecordHeader>();
+	header->level = record.level();
+	header->location = record.location();
+	header->unlimited = record.unlimited();
+	header->message = record.message();
+	int count = 0;
+	for (const Attr &attr : record.attributes()) {
+		if (count == MaxAttributes) {
+			break;
+		}
+		AttributeHeader *const attrHeader = out.Reserve<AttributeHeader>();
+		if (attrHeader == nullptr) {
+			break;
+		}
+		count++;
+		const Value &value = attr.value();
+		attrHeader->kind = value.ValueKind();
+		attrHeader->name = attr.name();
+		switch (value.ValueKind()) {
+		case Kind::Null:
+			break;
+		case Kind::Int:
+			attrHeader->intValue = value.IntValue();
+			break;
+		case Kind::Uint:
+			attrHeader->uintValue = value.UintValue();
+			break;
+		case Kind::Float:
+			attrHeader->floatValue = value.FloatValue();
+			break;
+		case Kind::Bool:
+			attrHeader->boolValue = value.BoolValue();
+			break;
+		case Kind::String: {
+			const std::string_view str = value.StringValue();
+			attrHeader->stringSize = out.Write(str.data(), str.size(), 1);
+		} break;
+		case Kind::WideString: {
+			const std::wstring_view str = value.WideStringValue();
+			attrHeader->stringSize = out.Write(
+				str.data(), str.size() * sizeof(wchar_t), alignof(wchar_t));
+		} break;
+		}
+	}
+	header->attributeCount = static_cast<std::uint8_t>(count);
+}
+
+// Deserialize a record from a slot. The record refers to data in the slot.
+Record Deserialize(const unsigned char *data) {
+	SlotReader in{data};
+	const RecordHeader &header = in.Read<RecordHeader>();
+	Record record{header.level, header.location, header.message};
+	if (header.unlimited) {
+		record.SetUnlimited();
+	}
+	for (int i = 0; i < header.attributeCount; i++) {
+		const AttributeHeader &attrHeader = in.Read<AttributeHeader>();
+		Value value;
+		switch (attrHeader.kind) {
+		case Kind::Null:
+			break;
+		case Kind::Int:
+			value = attrHeader.intValue;
+			break;
+		case Kind::Uint:
+			value = attrHeader.uintValue;
+			break;
+		case Kind::Float:
+			value = attrHeader.floatValue;
+			break;
+		case Kind::Bool:
+			value = attrHeader.boolValue;
+			break;
+		case Kind::String:
+			value = in.ReadString<char>(attrHeader.stringSize);
+			break;
+		case Kind::WideString:
+			value = in.ReadString<wchar_t>(attrHeader.stringSize);
+			break;
+		}
+		record.Add(attrHeader.name, value);
+	}
+	return record;
+}
+
+class AsyncLog {
+public:
+	AsyncLog()
+		: mEnqueuePos{0},
+		  mDequeuePos{0},
+		  mDropped{0},
+		  mStop{false},
+		  mFlushRequested{false} {
+		for (std::size_t i = 0; i < SlotCount; i++) {
+			mSlots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		mThread = std::thread{&AsyncLog::Run, this};
+	}
+	AsyncLog(const AsyncLog &) = delete;
+	AsyncLog &operator=(const AsyncLog &) = delete;
+
+	// Write any remaining records, and stop the writer thread.
+	void Stop() {
+		{
+			std::lock_guard<std::mutex> lock{mMutex};
+			mStop.store(true, std::memory_order_relaxed);
+		}
+		mWake.notify_one();
+		// If a record fails on the writer thread, it calls exit from that
+		// thread, and a thread can't join itself.
+		if (std::this_thread::get_id() == mThread.get_id()) {
+			return;
+		}
+		mThread.join();
+		// A thread may have loaded the pointer before it was cleared, and
+		// pushed a record after the writer thread's last pass.
+		Sink sink;
+		WriteAll(sink);
+	}
+
+	// Add a record to the ring. Returns false if the ring is full.
+	bool Push(const Record &record) {
+		std::size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+		Slot *slot;
+		for (;;) {
+			slot = &mSlots[pos & (SlotCount - 1)];
+			const std::size_t sequence =
+				slot->sequence.load(std::memory_order_acquire);
+			const std::intptr_t diff = static_cast<std::intptr_t>(sequence) -
+			                           static_cast<std::intptr_t>(pos);
+			if (diff == 0) {
+				if (mEnqueuePos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				mDropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			} else {
+				pos = mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		Serialize(slot->data, record);
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Wait until the records pushed so far have been written, or until the
+	// timeout expires.
+	void Flush() {
+		if (std::this_thread::get_id() == mThread.get_id()) {
+			return;
+		}
+		const std::size_t target =
+			mEnqueuePos.load(std::memory_order_relaxed);
+		std::unique_lock<std::mutex> lock{mMutex};
+		mFlushRequested = true;
+		mWake.notify_one();
+		mFlushed.wait_for(lock, FlushTimeout, [&] {
+			return mDequeuePos.load(std::memory_order_acquire) >= target;
+		});
+	}
+
+private:
+	// Write one record from the ring. Returns false if the ring is empty.
+	bool WriteOne(Sink &sink) {
+		const std::size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+		Slot &slot = mSlots[pos & (SlotCount - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+			return false;
+		}
+		sink.Log(Deserialize(slot.data));
+		slot.sequence.store(pos + SlotCount, std::memory_order_release);
+		mDequeuePos.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Write all records in the ring, and the count of dropped records.
+	// Returns true if any records were written.
+	bool WriteAll(Sink &sink) {
+		bool any = false;
+		while (WriteOne(sink)) {
+			any = true;
+		}
+		const unsigned long long dropped =
+			mDropped.exchange(0, std::memory_order_relaxed);
+		if (dropped != 0) {
+			sink.Log(Record{Level::Warn, Location::Zero, "Log records dropped.",
+			                Attr{"count", dropped}});
+		}
+		sink.LogSuppressed(false);
+		return any;
+	}
+
+	void Run() {
+		Sink sink;
+		for (;;) {
+			// Read the stop flag first, so records pushed before the flag
+			// was set are still written.
+			const bool stop = mStop.load(std::memory_order_relaxed);
+			if (WriteAll(sink)) {
+				// The ring is empty, so this is the end of a batch.
+				FlushJSON();
+			}
+			if (stop) {
+				return;
+			}
+			std::unique_lock<std::mutex> lock{mMutex};
+			mFlushed.notify_all();
+			mWake.wait_for(lock, PollInterval, [this] {
+				return mFlushRequested ||
+				       mStop.load(std::memory_order_relaxed);
+			});
+			mFlushRequested = false;
+		}
+	}
+
+	std::array<Slot, SlotCount> mSlots;
+	alignas(64) std::atomic<std::size_t> mEnqueuePos;
+	alignas(64) std::atomic<std::size_t> mDequeuePos;
+	std::atomic<unsigned long long> mDropped;
+	std::atomic<bool> mStop;
+	// Used to wake the writer thread for Flush and Stop, and to wake Flush
+	// when the writer thread finishes a pass.
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mFlushed;
+	bool mFlushRequested;
+	std::thread mThread;
+};
+
+// Never deleted, so it can be used by other static destructors. Null if the
+// writer thread is not running.
+std::atomic<AsyncLog *> Async;
+
+void StopAtExit() {
+	// Clear the pointer first, so records logged after this are written
+	// directly by the thread that logs them.
+	AsyncLog *const async = Async.exchange(nullptr, std::memory_order_acquire);
+	async->Stop();
+}
+
+} // namespace
+
+void StartAsync() {
+	if (Async.load(std::memory_order_relaxed) == nullptr) {
+		Async.store(new AsyncLog, std::memory_order_release);
+		// Registered after the binary log's handler, so this runs first.
+		std::atexit(StopAtExit);
+	}
+}
+
+bool IsAsync() {
+	return Async.load(std::memory_order_acquire) != nullptr;
+}
+
+bool PushAsync(const Record &record) {
+	AsyncLog *const async = Async.load(std::memory_order_acquire);
+	if (async == nullptr) {
+		return false;
+	}
+	async->Push(record);
+	return true;
+}
+
+void FlushAsync() {
+	AsyncLog *const async = Async.load(std::memory_order_acquire);
+	if (async != nullptr) {
+		async->Flush();
+	}
+}
+
+} // namespace log
+} // namespace demo
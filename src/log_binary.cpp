@@ -0,0 +1,269 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "log_internal.hpp"
+
+#include "log.hpp"
+#include "os_string.hpp"
+#include "var.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Binary log. Records are written without formatting, and the "tools
+// logdecode" command formats them later. Each call site is written once, with
+// its location, message, and attribute names, and records refer to it by ID.
+// Messages and attribute names are string literals, so sites are identified
+// by address.
+//
+// Format: little-endian. The file starts with BinaryMagic. Each entry starts
+// with a tag byte.
+//
+// - Site: tag 1, then u32 ID, u8 level, u32 line, the file, function, and
+//   message as strings, u8 attribute count, and the attribute names as
+//   strings.
+//
+// - Record: tag 2, then u32 site ID, and the attribute values. Each value is a
+//   u8 kind (log::Kind), and then i64, u64, f64, u8 for bool, a string, or a
+//   wide string.
+//
+// Strings are a u32 size followed by the bytes. Wide strings are a u32 count
+// followed by UTF-16 code units.
+
+namespace demo {
+namespace log {
+
+namespace {
+
+// First four bytes of a binary log: "LDB2".
+constexpr std::uint32_t BinaryMagic = 0x3242444c;
+
+enum class Tag : std::uint8_t {
+	Site = 1,
+	Record = 2,
+};
+
+// Buffered data is written once it reaches this size.
+constexpr std::size_t FlushSize = 64 * 1024;
+
+// Maximum number of attributes written for a record.
+constexpr std::size_t MaxAttributes = 255;
+
+// Identifies call sites with the same location, message, and level. These
+// may still have different attributes.
+struct SiteKey {
+	const char *file;
+	int line;
+	const char *message;
+	Level level;
+
+	bool operator==(const SiteKey &other) const = default;
+};
+
+struct SiteKeyHash {
+	std::size_t operator()(const SiteKey &key) const {
+		return std::hash<const char *>{}(key.file) ^
+		       std::hash<const char *>{}(key.message) ^
+		       (static_cast<std::size_t>(key.line) * 0x9e3779b9u) ^
+		       static_cast<std::size_t>(key.level);
+	}
+};
+
+// A call site which has been written to the log.
+struct Site {
+	std::uint32_t id;
+	// Attribute names, which refer to string literals.
+	std::vector<std::string_view> names;
+};
+
+// Return true if the attributes have the same names as a site, by address.
+bool HasNames(const Site &site, std::span<const Attr> attributes) {
+	if (site.names.size() != attributes.size()) {
+		return false;
+	}
+	for (std::size_t i = 0; i < attributes.size(); i++) {
+		const std::string_view name = attributes[i].name();
+		if (site.names[i].data() != name.data() ||
+		    site.names[i].size() != name.size()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+class BinaryLog {
+public:
+	explicit BinaryLog(std::FILE *file) : mFile{file}, mSiteCount{0} {
+		mBuffer.reserve(FlushSize * 2);
+		Put32(BinaryMagic);
+	}
+	BinaryLog(const BinaryLog &) = delete;
+	BinaryLog &operator=(const BinaryLog &) = delete;
+
+	void Log(const Record &record) {
+		std::span<const Attr> attributes = record.attributes();
+		attributes =
+			attributes.first(std::min(attributes.size(), MaxAttributes));
+		std::lock_guard<std::mutex> lock{mMutex};
+		const std::uint32_t site = SiteID(record, attributes);
+		Put8(static_cast<std::uint8_t>(Tag::Record));
+		Put32(site);
+		for (const Attr &attr : attributes) {
+			PutValue(attr.value());
+		}
+		if (mBuffer.size() >= FlushSize) {
+			WriteBuffer();
+		}
+	}
+
+	void Flush() {
+		std::lock_guard<std::mutex> lock{mMutex};
+		WriteBuffer();
+		std::fflush(mFile);
+	}
+
+private:
+	// Get the ID for a record's call site, writing the site if it is new.
+	std::uint32_t SiteID(const Record &record,
+	                     std::span<const Attr> attributes) {
+		const Location &location = record.location();
+		const SiteKey key{location.file.data(), location.line,
+		                  record.message().data(), record.level()};
+		std::vector<Site> &sites = mSites[key];
+		for (const Site &site : sites) {
+			if (HasNames(site, attributes)) {
+				return site.id;
+			}
+		}
+		const std::uint32_t id = mSiteCount++;
+		Site &site = sites.emplace_back(Site{id, {}});
+		Put8(static_cast<std::uint8_t>(Tag::Site));
+		Put32(id);
+		Put8(static_cast<std::uint8_t>(record.level()));
+		Put32(static_cast<std::uint32_t>(location.line));
+		PutString(location.file);
+		PutString(location.function);
+		PutString(record.message());
+		Put8(static_cast<std::uint8_t>(attributes.size()));
+		for (const Attr &attr : attributes) {
+			site.names.push_back(attr.name());
+			PutString(attr.name());
+		}
+		return id;
+	}
+
+	void PutValue(const Value &value) {
+		Put8(static_cast<std::uint8_t>(value.ValueKind()));
+		switch (value.ValueKind()) {
+		case Kind::Null:
+			break;
+		case Kind::Int:
+			Put64(static_cast<std::uint64_t>(value.IntValue()));
+			break;
+		case Kind::Uint:
+			Put64(value.UintValue());
+			break;
+		case Kind::Float: {
+			const double floatValue = value.FloatValue();
+			std::uint64_t bits;
+			std::memcpy(&bits, &floatValue, sizeof(bits));
+			Put64(bits);
+		} break;
+		case Kind::Bool:
+			Put8(value.BoolValue() ? 1 : 0);
+			break;
+		case Kind::String:
+			PutString(value.StringValue());
+			break;
+		case Kind::WideString: {
+			// Like TextBuffer::AppendWide, this treats wchar_t as UTF-16.
+			const std::wstring_view str = value.WideStringValue();
+			Put32(static_cast<std::uint32_t>(str.size()));
+			for (const wchar_t ch : str) {
+				const std::uint16_t unit = static_cast<std::uint16_t>(ch);
+				Put(&unit, sizeof(unit));
+			}
+		} break;
+		}
+	}
+
+	void Put(const void *ptr, std::size_t size) {
+		const unsigned char *const bytes =
+			static_cast<const unsigned char *>(ptr);
+		mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+	}
+	void Put8(std::uint8_t value) { mBuffer.push_back(value); }
+	void Put32(std::uint32_t value) { Put(&value, sizeof(value)); }
+	void Put64(std::uint64_t value) { Put(&value, sizeof(value)); }
+	void PutString(std::string_view str) {
+		Put32(static_cast<std::uint32_t>(str.size()));
+		Put(str.data(), str.size());
+	}
+
+	void WriteBuffer() {
+		if (!mBuffer.empty()) {
+			// Ignore errors, as with the text log.
+			(void)std::fwrite(mBuffer.data(), 1, mBuffer.size(), mFile);
+			mBuffer.clear();
+		}
+	}
+
+	std::mutex mMutex;
+	std::FILE *mFile;
+	std::vector<unsigned char> mBuffer;
+	std::unordered_map<SiteKey, std::vector<Site>, SiteKeyHash> mSites;
+	std::uint32_t mSiteCount;
+};
+
+// Never deleted, so it can be used by other static destructors.
+BinaryLog *Binary;
+
+void FlushAtExit() {
+	FlushBinary();
+}
+
+} // namespace
+
+void InitBinary() {
+	const os_string path{var::LogBinary.get()};
+	if (path.empty() || Binary != nullptr) {
+		return;
+	}
+#if _WIN32
+	std::FILE *const file = _wfopen(path.c_str(), L"wb");
+#else
+	std::FILE *const file = std::fopen(path.c_str(), "wb");
+#endif
+	if (file == nullptr) {
+		LOG(Error, "Could not open binary log.", Attr{"path", path});
+		return;
+	}
+	Binary = new BinaryLog(file);
+	std::atexit(FlushAtExit);
+}
+
+bool HasBinary() {
+	return Binary != nullptr;
+}
+
+void WriteBinary(const Record &record) {
+	Binary->Log(record);
+}
+
+void FlushBinary() {
+	if (Binary != nullptr) {
+		Binary->Flush();
+	}
+}
+
+} // namespace log
+} // namespace demo
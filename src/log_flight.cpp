@@ -0,0 +1,168 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "log_internal.hpp"
+
+#include "log.hpp"
+#include "os_string.hpp"
+#include "text_buffer.hpp"
+#include "var.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if _WIN32
+#include "os_windows.hpp"
+#else
+#include "os_unix.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Flight recorder. Records are written as text lines into a memory-mapped file,
+// which is used as a circular buffer. Writing a record is a copy into the
+// mapping, with no system calls. The operating system owns the mapped pages, so
+// the most recent records survive if the program crashes. The "tools
+// logdecode" command reads the file back in order.
+//
+// The file starts with a FlightHeader. The cursor is the total number of bytes
+// ever written, so the data is at cursor modulo the data size. The oldest line
+// in the file may be partially overwritten.
+
+namespace demo {
+namespace log {
+
+namespace {
+
+// First four bytes of a flight recorder file: "LDF1".
+constexpr std::uint32_t FlightMagic = 0x3146444c;
+
+// Size of the data area, in megabytes, if LogFlightSize is not set.
+constexpr int DefaultSizeMB = 4;
+
+struct FlightHeader {
+	std::uint32_t magic;
+	std::uint32_t headerSize;
+	std::uint64_t dataSize;
+	// Total bytes written. Updated atomically by writers.
+	std::uint64_t cursor;
+	std::uint64_t reserved[5];
+};
+
+static_assert(sizeof(FlightHeader) == 64);
+
+FlightHeader *Header;
+char *Data;
+std::uint64_t DataSize;
+
+// Map the file, and return a pointer to its contents, or null on failure.
+void *MapFile(const os_string &path, std::uint64_t size) {
+#if _WIN32
+	const HANDLE file =
+		CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+	                FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+	                FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		LOG(Error, "Could not open flight recorder.", Attr{"path", path},
+		    WindowsError::GetLast());
+		return nullptr;
+	}
+	HandleCloser fileCloser{file};
+	const HANDLE mapping = CreateFileMappingW(
+		file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+		static_cast<DWORD>(size), nullptr);
+	if (mapping == nullptr) {
+		LOG(Error, "Could not map flight recorder.", Attr{"path", path},
+		    WindowsError::GetLast());
+		return nullptr;
+	}
+	HandleCloser mappingCloser{mapping};
+	// The view keeps the mapping and file open.
+	void *const ptr = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+	if (ptr == nullptr) {
+		LOG(Error, "Could not map flight recorder.", Attr{"path", path},
+		    WindowsError::GetLast());
+	}
+	return ptr;
+#else
+	const int file =
+		::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (file < 0) {
+		LOG(Error, "Could not open flight recorder.", Attr{"path", path},
+		    UnixError::Get());
+		return nullptr;
+	}
+	void *ptr = nullptr;
+	if (::ftruncate(file, static_cast<off_t>(size)) != 0) {
+		LOG(Error, "Could not resize flight recorder.", Attr{"path", path},
+		    UnixError::Get());
+	} else {
+		ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file,
+		             0);
+		if (ptr == MAP_FAILED) {
+			LOG(Error, "Could not map flight recorder.", Attr{"path", path},
+			    UnixError::Get());
+			ptr = nullptr;
+		}
+	}
+	// The mapping keeps the file open.
+	::close(file);
+	return ptr;
+#endif
+}
+
+} // namespace
+
+void InitFlight() {
+	const os_string path{var::LogFlight.get()};
+	if (path.empty() || Header != nullptr) {
+		return;
+	}
+	const int sizeMB = var::LogFlightSize.get() > 0 ? var::LogFlightSize.get()
+	                                                 : DefaultSizeMB;
+	const std::uint64_t dataSize = static_cast<std::uint64_t>(sizeMB) << 20;
+	void *const ptr = MapFile(path, sizeof(FlightHeader) + dataSize);
+	if (ptr == nullptr) {
+		return;
+	}
+	FlightHeader *const header = static_cast<FlightHeader *>(ptr);
+	header->headerSize = sizeof(FlightHeader);
+	header->dataSize = dataSize;
+	header->cursor = 0;
+	header->magic = FlightMagic;
+	Data = static_cast<char *>(ptr) + sizeof(FlightHeader);
+	DataSize = dataSize;
+	Header = header;
+}
+
+bool HasFlight() {
+	return Header != nullptr;
+}
+
+void WriteFlight(const Record &record) {
+	char bufferData[LogBufferSize];
+	TextBuffer buffer{bufferData};
+	WriteLine(buffer, record, false, false);
+	// Keep only the end of a record larger than the buffer.
+	std::string_view line = buffer.Contents();
+	if (line.size() > DataSize) {
+		line = line.substr(line.size() - DataSize);
+	}
+	// Writers reserve space by advancing the cursor, so they can copy in
+	// parallel.
+	const std::uint64_t start =
+		std::atomic_ref<std::uint64_t>{Header->cursor}.fetch_add(
+			line.size(), std::memory_order_relaxed);
+	const std::size_t pos = static_cast<std::size_t>(start % DataSize);
+	const std::size_t first =
+		std::min(line.size(), static_cast<std::size_t>(DataSize - pos));
+	std::memcpy(Data + pos, line.data(), first);
+	std::memcpy(Data, line.data() + first, line.size() - first);
+}
+
+} // namespace log
+} // namespace demo
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: MPL-2.0
 #pragma once
 
+#include "log_standard.hpp"
 #include "text_buffer.hpp"
 
 #if _WIN32
@@ -10,6 +11,8 @@
 #endif
 
 #include <cstddef>
+#include <string>
+#include <vector>
 
 namespace demo {
 namespace log {
@@ -78,5 +81,90 @@ using Writer = UnixWriter;
 
 #endif
 
+// Open the binary log, if the LogBinary variable is set.
+void InitBinary();
+
+// Return true if the binary log is open.
+bool HasBinary();
+
+// Write a record to the binary log.
+void WriteBinary(const Record &record);
+
+// Write buffered records in the binary log to disk. Does nothing if the binary
+// log is not open.
+void FlushBinary();
+
+// Open the JSON Lines log, if the LogJSON variable is set.
+void InitJSON();
+
+// Return true if the JSON Lines log is open.
+bool HasJSON();
+
+// Add a record to the JSON Lines log. The record is buffered.
+void WriteJSON(const Record &record);
+
+// Write the buffered records in the JSON Lines log. Does nothing if the JSON
+// Lines log is not open.
+void FlushJSON();
+
+// Open the flight recorder, if the LogFlight variable is set.
+void InitFlight();
+
+// Return true if the flight recorder is open.
+bool HasFlight();
+
+// Write a record to the flight recorder. This does not make system calls.
+void WriteFlight(const Record &record);
+
+// Check the rate limit for writing a record as text. Returns true if the
+// record should be written. If records from the same call site were
+// suppressed since the last one written, sets suppressed to their count, and
+// otherwise sets it to zero.
+bool CheckRateLimit(const Record &record, unsigned long long *suppressed);
+
+// Count of records suppressed by the rate limit from one call site.
+struct SuppressedSite {
+	Location location;
+	// The message, for records without a location.
+	std::string message;
+	unsigned long long count;
+};
+
+// Take the suppressed counts for every call site, and reset them. Does
+// nothing if this was called less than a second ago, unless force is true.
+void TakeSuppressed(std::vector<SuppressedSite> *sites, bool force);
+
+// Destination for log records. Records are written to the JSON Lines log and
+// the binary log, if they are open. If the binary log is not open, or for
+// warnings and errors, records are also written as text, subject to the rate
+// limit.
+class Sink {
+public:
+	void Log(const Record &record);
+
+	// Write the counts of records suppressed by the rate limit, at most once
+	// per second, or now if force is true.
+	void LogSuppressed(bool force);
+
+private:
+	Writer mWriter;
+};
+
+// Start the writer thread for asynchronous logging. After this, records are
+// queued and written by the writer thread.
+void StartAsync();
+
+// Return true if the writer thread is running. It stops at exit.
+bool IsAsync();
+
+// Queue a record for the writer thread. Never blocks. If the queue is full,
+// the record is dropped. Returns false if the writer thread is not running, in
+// which case the caller should write the record itself.
+bool PushAsync(const Record &record);
+
+// Wait for the writer thread to write all queued records. Does nothing if
+// asynchronous logging is not enabled.
+void FlushAsync();
+
 } // namespace log
 } // namespace demo
@@ -0,0 +1,337 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "log_internal.hpp"
+
+#include "log.hpp"
+#include "os_string.hpp"
+#include "text_buffer.hpp"
+#include "text_unicode.hpp"
+#include "var.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#if _WIN32
+#include "os_windows.hpp"
+#else
+#include "os_unix.hpp"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// JSON Lines log. Each record is a JSON object on its own line, with the same
+// fields as Go's slog.JSONHandler: "level", "source", "msg", and then the
+// attributes, with their types preserved. Records are formatted into a list of
+// chunks, and the chunks are written together with one call to writev, either
+// when enough data is buffered or at the end of a frame.
+
+namespace demo {
+namespace log {
+
+namespace {
+
+// Size of each chunk. Larger records get their own chunk.
+constexpr std::size_t ChunkSize = 16 * 1024;
+
+// Buffered data is written once this many chunks are full.
+constexpr std::size_t FlushChunks = 8;
+
+const std::string_view LevelNames[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+const char HexDigit[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                           '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+void AppendUnicodeEscape(TextBuffer &out, unsigned ch) {
+	out.Append("\\u");
+	for (int shift = 12; shift >= 0; shift -= 4) {
+		out.AppendChar(HexDigit[(ch >> shift) & 15]);
+	}
+}
+
+// Append an escaped ASCII character. Returns false if the character does not
+// need to be escaped.
+bool AppendASCIIEscape(TextBuffer &out, unsigned ch) {
+	switch (ch) {
+	case '"':
+		out.Append("\\\"");
+		return true;
+	case '\\':
+		out.Append("\\\\");
+		return true;
+	case '\n':
+		out.Append("\\n");
+		return true;
+	case '\r':
+		out.Append("\\r");
+		return true;
+	case '\t':
+		out.Append("\\t");
+		return true;
+	}
+	if (ch < 32 || ch == 127) {
+		AppendUnicodeEscape(out, ch);
+		return true;
+	}
+	return false;
+}
+
+void AppendUTF8(TextBuffer &out, char32_t ch) {
+	char data[4];
+	const char *const end = unicode::WriteUTF8(data, ch);
+	out.Append(data, end - data);
+}
+
+// Append a JSON string. Invalid UTF-8 is replaced.
+void AppendString(TextBuffer &out, std::string_view str) {
+	out.AppendChar('"');
+	const char *ptr = str.data(), *const end = ptr + str.size();
+	while (ptr != end) {
+		const unsigned ch = static_cast<unsigned char>(*ptr);
+		if (ch < 0x80) {
+			ptr++;
+			if (!AppendASCIIEscape(out, ch)) {
+				out.AppendChar(static_cast<char>(ch));
+			}
+		} else {
+			const unicode::UTF8Result result = unicode::ReadUTF8(ptr, end);
+			if (result.ok) {
+				out.Append(ptr, result.ptr - ptr);
+				ptr = result.ptr;
+			} else {
+				ptr++;
+				AppendUTF8(out, unicode::ReplacementCharacter);
+			}
+		}
+	}
+	out.AppendChar('"');
+}
+
+// Append a JSON string from UTF-16. Unpaired surrogates are replaced.
+void AppendWideString(TextBuffer &out, std::wstring_view str) {
+	out.AppendChar('"');
+	const wchar_t *ptr = str.data(), *const end = ptr + str.size();
+	while (ptr != end) {
+		const char16_t ch = static_cast<char16_t>(*ptr++);
+		if (ch < 0x80) {
+			if (!AppendASCIIEscape(out, ch)) {
+				out.AppendChar(static_cast<char>(ch));
+			}
+		} else if (!unicode::IsSurrogate(ch)) {
+			AppendUTF8(out, ch);
+		} else if (unicode::IsSurrogateHigh(ch) && ptr != end &&
+		           unicode::IsSurrogateLow(static_cast<char16_t>(*ptr))) {
+			AppendUTF8(out, unicode::DecodeSurrogatePair(
+								ch, static_cast<char16_t>(*ptr++)));
+		} else {
+			AppendUTF8(out, unicode::ReplacementCharacter);
+		}
+	}
+	out.AppendChar('"');
+}
+
+void AppendValue(TextBuffer &out, const Value &value) {
+	switch (value.ValueKind()) {
+	case Kind::Null:
+		out.Append("null");
+		break;
+	case Kind::Int:
+		out.AppendNumber(value.IntValue());
+		break;
+	case Kind::Uint:
+		out.AppendNumber(value.UintValue());
+		break;
+	case Kind::Float: {
+		// JSON has no infinity or NaN.
+		const double floatValue = value.FloatValue();
+		if (std::isfinite(floatValue)) {
+			out.AppendNumber(floatValue);
+		} else {
+			out.AppendChar('"');
+			out.AppendNumber(floatValue);
+			out.AppendChar('"');
+		}
+	} break;
+	case Kind::Bool:
+		out.AppendBool(value.BoolValue());
+		break;
+	case Kind::String:
+		AppendString(out, value.StringValue());
+		break;
+	case Kind::WideString:
+		AppendWideString(out, value.WideStringValue());
+		break;
+	}
+}
+
+void AppendRecord(TextBuffer &out, const Record &record) {
+	out.Append("{\"level\":\"");
+	out.Append(LevelNames[static_cast<int>(record.level())]);
+	out.AppendChar('"');
+	const Location &location = record.location();
+	if (!location.is_empty()) {
+		out.Append(",\"source\":{\"function\":");
+		AppendString(out, location.function);
+		out.Append(",\"file\":");
+		AppendString(out, location.file);
+		out.Append(",\"line\":");
+		out.AppendNumber(location.line);
+		out.AppendChar('}');
+	}
+	out.Append(",\"msg\":");
+	AppendString(out, record.message());
+	for (const Attr &attr : record.attributes()) {
+		out.AppendChar(',');
+		AppendString(out, attr.name());
+		out.AppendChar(':');
+		AppendValue(out, attr.value());
+	}
+	out.Append("}\n");
+}
+
+class JSONLog {
+public:
+#if _WIN32
+	using Handle = HANDLE;
+#else
+	using Handle = int;
+#endif
+
+	explicit JSONLog(Handle file) : mFile{file}, mChunkCount{0} {}
+	JSONLog(const JSONLog &) = delete;
+	JSONLog &operator=(const JSONLog &) = delete;
+
+	void Log(const Record &record) {
+		std::lock_guard<std::mutex> lock{mMutex};
+		mLine.Clear();
+		AppendRecord(mLine, record);
+		const std::string_view line = mLine.Contents();
+		if (mChunkCount == 0 ||
+		    mChunks[mChunkCount - 1].size() + line.size() > ChunkSize) {
+			if (mChunkCount == mChunks.size()) {
+				mChunks.emplace_back().reserve(ChunkSize);
+			}
+			mChunkCount++;
+		}
+		std::vector<char> &chunk = mChunks[mChunkCount - 1];
+		chunk.insert(chunk.end(), line.begin(), line.end());
+		if (mChunkCount > FlushChunks) {
+			WriteChunks();
+		}
+	}
+
+	void Flush() {
+		std::lock_guard<std::mutex> lock{mMutex};
+		WriteChunks();
+	}
+
+private:
+	// Write the chunks and empty them, keeping their memory. Errors are
+	// ignored, as with the text log.
+	void WriteChunks() {
+		if (mChunkCount == 0) {
+			return;
+		}
+#if _WIN32
+		for (std::size_t i = 0; i < mChunkCount; i++) {
+			DWORD written;
+			(void)::WriteFile(mFile, mChunks[i].data(),
+			                  static_cast<DWORD>(mChunks[i].size()), &written,
+			                  nullptr);
+		}
+#else
+		iovec iov[FlushChunks + 1];
+		for (std::size_t i = 0; i < mChunkCount; i++) {
+			iov[i].iov_base = mChunks[i].data();
+			iov[i].iov_len = mChunks[i].size();
+		}
+		// Resume after partial writes.
+		iovec *pos = iov, *const end = iov + mChunkCount;
+		while (pos != end) {
+			const ssize_t written =
+				::writev(mFile, pos, static_cast<int>(end - pos));
+			if (written < 0) {
+				break;
+			}
+			std::size_t remaining = static_cast<std::size_t>(written);
+			while (pos != end && remaining >= pos->iov_len) {
+				remaining -= pos->iov_len;
+				pos++;
+			}
+			if (pos != end) {
+				pos->iov_base = static_cast<char *>(pos->iov_base) + remaining;
+				pos->iov_len -= remaining;
+			}
+		}
+#endif
+		for (std::size_t i = 0; i < mChunkCount; i++) {
+			mChunks[i].clear();
+		}
+		mChunkCount = 0;
+	}
+
+	std::mutex mMutex;
+	Handle mFile;
+	TextBuffer mLine;
+	// Chunks are reused. Only the first mChunkCount contain data.
+	std::vector<std::vector<char>> mChunks;
+	std::size_t mChunkCount;
+};
+
+// Never deleted, so it can be used by other static destructors.
+JSONLog *JSON;
+
+void FlushAtExit() {
+	FlushJSON();
+}
+
+} // namespace
+
+void InitJSON() {
+	const os_string path{var::LogJSON.get()};
+	if (path.empty() || JSON != nullptr) {
+		return;
+	}
+#if _WIN32
+	const HANDLE file =
+		CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+	                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		LOG(Error, "Could not open JSON log.", Attr{"path", path},
+		    WindowsError::GetLast());
+		return;
+	}
+#else
+	const int file =
+		::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (file < 0) {
+		LOG(Error, "Could not open JSON log.", Attr{"path", path},
+		    UnixError::Get());
+		return;
+	}
+#endif
+	JSON = new JSONLog(file);
+	std::atexit(FlushAtExit);
+}
+
+bool HasJSON() {
+	return JSON != nullptr;
+}
+
+void WriteJSON(const Record &record) {
+	JSON->Log(record);
+}
+
+void FlushJSON() {
+	if (JSON != nullptr) {
+		JSON->Flush();
+	}
+}
+
+} // namespace log
+} // namespace demo
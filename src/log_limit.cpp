@@ -0,0 +1,119 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "log_internal.hpp"
+
+#include "log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Rate limiting for the text log. Each call site has a token bucket, so a call
+// site which logs every frame can't flood the log and stall the frame on
+// writes. Suppressed records are counted, and the count is reported before the
+// next record from the same call site is written, or by the next sweep.
+
+namespace demo {
+namespace log {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Number of records a call site can write in a burst.
+constexpr double BurstSize = 20.0;
+
+// Number of records per second a call site can write after a burst.
+constexpr double RecordsPerSecond = 5.0;
+
+// Minimum time between sweeps for suppressed counts.
+constexpr std::chrono::seconds SweepInterval{1};
+
+// Call sites are identified by location. Locations refer to string literals,
+// so the file is compared by address. Records without a location, like
+// messages from callbacks, are identified by message instead.
+struct SiteKey {
+	const char *file;
+	int line;
+	std::string message;
+
+	bool operator==(const SiteKey &other) const = default;
+};
+
+struct SiteKeyHash {
+	std::size_t operator()(const SiteKey &key) const {
+		return std::hash<const char *>{}(key.file) ^
+		       (static_cast<std::size_t>(key.line) * 0x9e3779b9u) ^
+		       std::hash<std::string>{}(key.message);
+	}
+};
+
+struct Bucket {
+	double tokens;
+	Clock::time_point time;
+	unsigned long long suppressed;
+	Location location;
+};
+
+std::mutex Mutex;
+std::unordered_map<SiteKey, Bucket, SiteKeyHash> Buckets;
+Clock::time_point LastSweep;
+
+} // namespace
+
+bool CheckRateLimit(const Record &record, unsigned long long *suppressed) {
+	// Errors are rare and important. Unlimited records come from reports
+	// which are already limited by how often they run.
+	if (record.level() >= Level::Error || record.unlimited()) {
+		*suppressed = 0;
+		return true;
+	}
+	const Location &location = record.location();
+	SiteKey key{location.file.data(), location.line, {}};
+	if (location.is_empty()) {
+		key.message = record.message();
+	}
+	const Clock::time_point now = Clock::now();
+	std::lock_guard<std::mutex> lock{Mutex};
+	Bucket &bucket =
+		Buckets
+			.try_emplace(std::move(key), Bucket{BurstSize, now, 0, location})
+			.first->second;
+	const double elapsed =
+		std::chrono::duration<double>(now - bucket.time).count();
+	bucket.tokens =
+		std::min(BurstSize, bucket.tokens + elapsed * RecordsPerSecond);
+	bucket.time = now;
+	if (bucket.tokens < 1.0) {
+		bucket.suppressed++;
+		return false;
+	}
+	bucket.tokens -= 1.0;
+	*suppressed = bucket.suppressed;
+	bucket.suppressed = 0;
+	return true;
+}
+
+void TakeSuppressed(std::vector<SuppressedSite> *sites, bool force) {
+	const Clock::time_point now = Clock::now();
+	std::lock_guard<std::mutex> lock{Mutex};
+	if (!force && now - LastSweep < SweepInterval) {
+		return;
+	}
+	LastSweep = now;
+	for (auto &[key, bucket] : Buckets) {
+		if (bucket.suppressed != 0) {
+			sites->push_back(SuppressedSite{bucket.location, key.message,
+			                                bucket.suppressed});
+			bucket.suppressed = 0;
+		}
+	}
+}
+
+} // namespace log
+} // namespace demo
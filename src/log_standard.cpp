@@ -6,7 +6,13 @@
 #include "log_internal.hpp"
 #include "main.hpp"
 #include "text_buffer.hpp"
+#include "os_string.hpp"
+#include "var.hpp"
 
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
+#include <string>
 #include <string_view>
 
 namespace demo {
@@ -14,6 +20,8 @@ namespace log {
 
 const Location Location::Zero{};
 
+Level MinLevel = Level::Debug;
+
 namespace {
 
 bool HasLog;
@@ -177,21 +185,143 @@ void WriteBlock(TextBuffer &buffer, const Record &record) {
 	}
 }
 
+namespace {
+
+// Return true if the name matches the level's name, ignoring case and the
+// padding in the level's name.
+bool IsLevelName(std::string_view name, std::string_view levelName) {
+	while (!levelName.empty() && levelName.back() == ' ') {
+		levelName.remove_suffix(1);
+	}
+	if (name.size() != levelName.size()) {
+		return false;
+	}
+	for (std::size_t i = 0; i < name.size(); i++) {
+		if (std::toupper(static_cast<unsigned char>(name[i])) != levelName[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Set the runtime level from the LogLevel variable.
+void InitLevel() {
+	const std::string name = ToString(var::LogLevel.get());
+	if (name.empty()) {
+		return;
+	}
+	for (int i = 0; i < static_cast<int>(std::size(Levels)); i++) {
+		if (IsLevelName(name, Levels[i].name)) {
+			MinLevel = static_cast<Level>(i);
+			return;
+		}
+	}
+	LOG(Warn, "Unknown log level.", Attr{"level", name});
+}
+
+// Report suppressed records which were never followed by another record from
+// the same call site.
+void LogSuppressedAtExit() {
+	Sink sink;
+	sink.LogSuppressed(true);
+}
+
+} // namespace
+
 void Init() {
 	HasLog = Writer::Init();
+	InitLevel();
+	InitBinary();
+	InitJSON();
+	InitFlight();
+	// On Windows, there may be no console, but records can still go to files.
+	HasLog = HasLog || HasBinary() || HasJSON() || HasFlight();
+	if (!HasLog) {
+		return;
+	}
+	// Registered before the writer thread starts, so this runs after it stops.
+	std::atexit(LogSuppressedAtExit);
+	if (var::LogAsync.get()) {
+		StartAsync();
+	}
+}
+
+void Sink::Log(const Record &record) {
+	if (HasJSON()) {
+		WriteJSON(record);
+	}
+	if (HasBinary()) {
+		WriteBinary(record);
+		if (record.level() < Level::Warn) {
+			return;
+		}
+	}
+	unsigned long long suppressed;
+	if (!CheckRateLimit(record, &suppressed)) {
+		return;
+	}
+	if (suppressed != 0) {
+		Record summary{Level::Warn, record.location(),
+		               "Suppressed repeated log messages.",
+		               Attr{"count", suppressed}};
+		if (record.location().is_empty()) {
+			summary.Add("message", record.message());
+		}
+		mWriter.Log(summary);
+	}
+	mWriter.Log(record);
+}
+
+void Sink::LogSuppressed(bool force) {
+	std::vector<SuppressedSite> sites;
+	TakeSuppressed(&sites, force);
+	for (const SuppressedSite &site : sites) {
+		Record record{Level::Warn, site.location,
+		              "Suppressed repeated log messages.",
+		              Attr{"count", site.count}};
+		if (!site.message.empty()) {
+			record.Add("message", site.message);
+		}
+		mWriter.Log(record);
+	}
 }
 
 void Record::Log() const {
-	if (!HasLog) {
+	if (!HasLog || !IsEnabled(mLevel)) {
 		return;
 	}
+	// Written on this thread, so the record survives even if it is still
+	// queued when the program crashes.
+	if (HasFlight()) {
+		WriteFlight(*this);
+	}
 
-	Writer writer;
-	writer.Log(*this);
+	if (PushAsync(*this)) {
+		return;
+	}
+	Sink sink;
+	sink.Log(*this);
+}
+
+void Flush() {
+	// With asynchronous logging, the writer thread flushes.
+	if (IsAsync()) {
+		return;
+	}
+	Sink sink;
+	sink.LogSuppressed(false);
+	FlushJSON();
 }
 
 [[noreturn]]
 void Record::Fail() const {
+	if (HasFlight()) {
+		WriteFlight(*this);
+	}
+	// Write queued records first, so they appear before the error.
+	FlushAsync();
+	FlushBinary();
+	FlushJSON();
 	Writer writer;
 	writer.Fail(*this);
 }
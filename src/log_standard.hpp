@@ -5,6 +5,7 @@
 
 // Standard logging, for non-compo builds.
 
+#include <array>
 #include <cstddef>
 #include <span>
 #include <string_view>
@@ -22,6 +23,22 @@ enum class Level {
 	Error,
 };
 
+// Minimum level compiled into the program. Log statements below this level
+// are removed at compile time. Set to a level name, like Info.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL Debug
+#endif
+
+constexpr Level MinCompiledLevel = Level::LOG_MIN_LEVEL;
+
+// Minimum level to log at runtime, set by the LogLevel variable.
+extern Level MinLevel;
+
+// Return true if messages at the given level are logged.
+inline bool IsEnabled(Level level) {
+	return level >= MinCompiledLevel && level >= MinLevel;
+}
+
 // A kind of value that can be logged.
 enum class Kind {
 	Null,
@@ -165,7 +182,8 @@ concept AttributeProvider = requires(const T &t, Record &r) {
 	{ t.AddToRecord(r) };
 };
 
-// A key-value pair that can be part of a log message.
+// A key-value pair that can be part of a log message. The name must be a string
+// literal, or otherwise last until exit, since logs keep it by address.
 class Attr {
 public:
 	constexpr Attr() = default;
@@ -185,6 +203,9 @@ private:
 // Initialize the logging system.
 void Init();
 
+// Write buffered log records to the log files. Call once per frame.
+void Flush();
+
 // A location in the source code.
 struct Location {
 	std::string_view file;
@@ -196,17 +217,26 @@ struct Location {
 	bool is_empty() const { return file.empty(); }
 };
 
-// A record of a log message.
+// Number of attributes a record can hold without allocating memory.
+constexpr std::size_t InlineAttributeCount = 8;
+
+// A record of a log message. The message must be a string literal, or otherwise
+// last until exit, since logs keep it by address. Put anything which varies in
+// the attributes.
 class Record {
 public:
-	Record() : mLevel{}, mLocation{}, mMessage{}, mAttributes{} {}
+	Record()
+		: mLevel{}, mLocation{}, mMessage{}, mInlineAttributes{},
+		  mInlineCount{0}, mUnlimited{false} {}
 
 	Record(Level level, Location location, std::string_view message)
-		: mLevel{level}, mLocation{location}, mMessage{message} {}
+		: mLevel{level}, mLocation{location}, mMessage{message},
+		  mInlineAttributes{}, mInlineCount{0}, mUnlimited{false} {}
 
 	Record(Level level, Location location, std::string_view message,
 	       const AttributeProvider auto &...attrs)
-		: mLevel{level}, mLocation{location}, mMessage{message} {
+		: mLevel{level}, mLocation{location}, mMessage{message},
+		  mInlineAttributes{}, mInlineCount{0}, mUnlimited{false} {
 		// Note: Above, the attrs parameter is const auto& for lifetime
 		// extension, since some AttributeProvider instances own data.
 		((void)attrs.AddToRecord(*this), ...);
@@ -221,10 +251,30 @@ public:
 	Level level() const { return mLevel; }
 	const Location &location() const { return mLocation; }
 	std::string_view message() const { return mMessage; }
-	std::span<const Attr> attributes() const { return mAttributes; }
+	std::span<const Attr> attributes() const {
+		if (!mAttributes.empty()) {
+			return mAttributes;
+		}
+		return {mInlineAttributes.data(), mInlineCount};
+	}
+	bool unlimited() const { return mUnlimited; }
+
+	// Exempt this record from the rate limit for the text log. For reports
+	// which write many records from one call site, and which are already
+	// limited by how often they run.
+	void SetUnlimited() { mUnlimited = true; }
 
-	// Add an attribute to the record.
+	// Add an attribute to the record. This only allocates memory if the
+	// record has more than InlineAttributeCount attributes.
 	void Add(std::string_view name, Value value) {
+		if (mAttributes.empty()) {
+			if (mInlineCount < InlineAttributeCount) {
+				mInlineAttributes[mInlineCount++] = Attr{name, value};
+				return;
+			}
+			mAttributes.assign(mInlineAttributes.begin(),
+			                   mInlineAttributes.end());
+		}
 		mAttributes.emplace_back(name, value);
 	}
 
@@ -239,7 +289,12 @@ private:
 	Level mLevel;
 	Location mLocation;
 	std::string_view mMessage;
+	// Attributes are stored inline, unless there are too many. Then they are
+	// all moved to mAttributes.
+	std::array<Attr, InlineAttributeCount> mInlineAttributes;
+	std::size_t mInlineCount;
 	std::vector<Attr> mAttributes;
+	bool mUnlimited;
 };
 
 inline void Attr::AddToRecord(Record &record) const {
@@ -5,9 +5,15 @@
 
 #include "gl.hpp"
 #include "gl_debug.hpp"
+#include "gl_profile.hpp"
 #include "gl_shader.hpp"
+#include "gl_trace.hpp"
 #include "log.hpp"
+#include "metrics.hpp"
+#include "os_string.hpp"
 #include "scene_cube.hpp"
+#include "scene_waves.hpp"
+#include "timeline.hpp"
 #include "var.hpp"
 
 #define GLFW_INCLUDE_NONE
@@ -59,6 +65,19 @@ extern "C" void ErrorCallback(int error, const char *description) {
 		.Log();
 }
 
+// Return true if the Scene variable selects the waves scene.
+bool IsWavesScene() {
+	const std::string name = ToString(var::Scene.get());
+	if (name.empty() || name == "cube") {
+		return false;
+	}
+	if (name == "waves") {
+		return true;
+	}
+	LOG(Warn, "Unknown scene.", log::Attr{"scene", name});
+	return false;
+}
+
 #endif
 
 void Main() {
@@ -73,9 +92,11 @@ void Main() {
 
 	glfwSetErrorCallback(ErrorCallback);
 #endif
+	timeline::BeginPhase("glfwInit");
 	if (!glfwInit()) {
 		FAIL_GLFW("Could not initialize GLFW.");
 	}
+	timeline::EndPhase();
 
 	// All of these are necessary.
 	//
@@ -91,6 +112,7 @@ void Main() {
 	// - With AMD or Nvidia drivers on Linux or Windows, you will always get
 	// the
 	//   highest version supported even without any hints.
+	timeline::BeginPhase("Create window");
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -109,28 +131,91 @@ void Main() {
 	}
 
 	glfwMakeContextCurrent(window);
+	timeline::EndPhase();
+	timeline::BeginPhase("gl_api::LoadProcs");
 	gl_api::LoadProcs();
+	timeline::EndPhase();
+#if !COMPO
+	gl_trace::Init();
+	gl_profile::Init();
+#endif
+	timeline::BeginPhase("gl_api::LoadExtensions");
 	gl_api::LoadExtensions();
+	timeline::EndPhase();
 #if !COMPO
 	if (var::DebugContext.get()) {
 		gl_debug::Init();
 	}
 #endif
+	timeline::BeginPhase("gl_shader::Init");
 	gl_shader::Init();
-	scene::Cube scene;
-	scene.Init();
+	timeline::EndPhase();
+	timeline::BeginPhase("Scene init");
+	scene::Cube cube;
+#if !COMPO
+	scene::Waves waves;
+	const bool showWaves = IsWavesScene();
+	if (showWaves) {
+		waves.Init();
+	} else {
+		cube.Init();
+	}
+#else
+	cube.Init();
+#endif
+	timeline::EndPhase();
 
 	glfwSwapInterval(1);
 
+	// Shaders may still be compiling in the background.
+	timeline::BeginPhase("Wait for shaders");
+	bool shadersReady = false;
+	bool firstFrame = true;
 	while (!glfwWindowShouldClose(window)) {
 		int width, height;
 		glfwGetFramebufferSize(window, &width, &height);
 		glViewport(0, 0, width, height);
 
-		double time = glfwGetTime();
-		scene.Render(time);
+		if (!shadersReady) {
+			shadersReady = gl_shader::Poll();
+			if (shadersReady) {
+				timeline::EndPhase();
+			}
+		}
+		if (shadersReady) {
+#if !COMPO
+			gl_shader::Update();
+			gl_shader::UpdateVariants();
+#endif
+			double time = glfwGetTime();
+#if !COMPO
+			if (showWaves) {
+				waves.Render(time, height);
+			} else {
+				cube.Render(time);
+			}
+#else
+			cube.Render(time);
+#endif
+		} else {
+			// Shaders are still compiling. Draw a blank frame, so the window
+			// stays responsive in the meantime.
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
 
 		glfwSwapBuffers(window);
+#if !COMPO
+		gl_debug::EndFrame();
+		gl_trace::EndFrame();
+		gl_profile::EndFrame();
+		metrics::EndFrame();
+		log::Flush();
+#endif
+		if (shadersReady && firstFrame) {
+			timeline::Finish();
+			firstFrame = false;
+		}
 		glfwPollEvents();
 	}
 
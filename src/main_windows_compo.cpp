@@ -5,10 +5,14 @@
 
 #include "gl.hpp"
 #include "gl_shader.hpp"
+#include "hash.hpp"
 #include "log.hpp"
 #include "scene_cube.hpp"
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
 
 #define NOMINMAX 1
 #undef UNICODE
@@ -19,13 +23,70 @@ namespace demo {
 
 namespace gl_api {
 
+#if GL_NAME_HASHES
+
+namespace {
+
+// Load the OpenGL 1.1 entry points by walking the export table of
+// opengl32.dll, and matching each exported name against the table of name
+// hashes. The executable then needs no import entries or names for them.
+void LoadExports() {
+	const char *const base =
+		reinterpret_cast<const char *>(GetModuleHandleA("opengl32.dll"));
+	CHECK(base != nullptr);
+	const IMAGE_DOS_HEADER *const dosHeader =
+		reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+	const IMAGE_NT_HEADERS *const ntHeaders =
+		reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+	const IMAGE_DATA_DIRECTORY &directory =
+		ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+	const IMAGE_EXPORT_DIRECTORY *const exports =
+		reinterpret_cast<const IMAGE_EXPORT_DIRECTORY *>(
+			base + directory.VirtualAddress);
+	const DWORD *const names =
+		reinterpret_cast<const DWORD *>(base + exports->AddressOfNames);
+	const WORD *const ordinals =
+		reinterpret_cast<const WORD *>(base + exports->AddressOfNameOrdinals);
+	const DWORD *const functions =
+		reinterpret_cast<const DWORD *>(base + exports->AddressOfFunctions);
+	for (DWORD i = 0; i < exports->NumberOfNames; i++) {
+		const std::string_view name{base + names[i]};
+		if (!name.starts_with("gl")) {
+			continue;
+		}
+		const std::uint32_t nameHash = hash::Hash32(FunctionHashSeed, name);
+		const int slot =
+			hash::PerfectHashSlot(nameHash, FunctionDisplacements,
+		                          FunctionBucketBits, FunctionHashBits);
+		const int index = FunctionHashTable[slot] - 1;
+		if (index >= 0 && FunctionHashes[index] == nameHash) {
+			FunctionPointers[index] =
+				const_cast<char *>(base + functions[ordinals[i]]);
+		}
+	}
+	for (int i = 0; i < FunctionHashCount; i++) {
+		CHECK(FunctionPointers[i] != nullptr);
+	}
+}
+
+} // namespace
+
+#endif
+
 // Load OpenGL entry points.
 void LoadProcs() {
+	int first = 0;
+#if GL_NAME_HASHES
+	LoadExports();
+	first = FunctionHashCount;
+#endif
+	// Entry points after OpenGL 1.1 come from the driver, which only looks
+	// them up by name.
 	const char *namePtr = FunctionNames;
-	for (int i = 0; i < FunctionPointerCount; i++) {
+	for (int i = first; i < FunctionPointerCount; i++) {
 		PROC proc = wglGetProcAddress(namePtr);
 		CHECK(proc != nullptr);
-		FunctionPointers[i] = static_cast<void *>(proc);
+		FunctionPointers[i] = reinterpret_cast<void *>(proc);
 		namePtr += std::strlen(namePtr) + 1;
 	}
 }
@@ -0,0 +1,106 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "mesh_lod.hpp"
+
+#include "log.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace demo {
+namespace mesh {
+
+namespace {
+
+// A coarser level is only selected if its error is below this fraction of the
+// threshold. This gives a band where neither the finer nor the coarser level
+// will switch, so objects near the boundary don't pop back and forth.
+constexpr float CoarsenRatio = 0.75f;
+
+// Return the number of cells along one side of a grid level with the given
+// stride.
+int CellCount(int size, int stride) {
+	return (size - 1) / stride;
+}
+
+} // namespace
+
+void LODChain::AddLevel(const Level &level) {
+	CHECK(mLevelCount < MaxLevels);
+	mLevels[mLevelCount++] = level;
+}
+
+int LODChain::Select(float errorScale, float threshold, int current) const {
+	if (mLevelCount == 0) {
+		return 0;
+	}
+	int level = std::clamp(current, 0, mLevelCount - 1);
+	// Refine until the error is acceptable.
+	while (level > 0 && mLevels[level].error * errorScale > threshold) {
+		level--;
+	}
+	// Coarsen while the next level is comfortably below the threshold.
+	while (level + 1 < mLevelCount &&
+	       mLevels[level + 1].error * errorScale <= threshold * CoarsenRatio) {
+		level++;
+	}
+	return level;
+}
+
+float PixelScale(float fovY, float viewportHeight) {
+	return viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+}
+
+void BuildGrid(LODChain *chain, std::span<unsigned short> indexes, int size,
+               std::span<const float> heights) {
+	CHECK(size >= 2 && size <= 256);
+	CHECK(((size - 1) & (size - 2)) == 0);
+	CHECK(static_cast<int>(heights.size()) == size * size);
+	CHECK(static_cast<int>(indexes.size()) >= GridIndexCount(size));
+
+	int pos = 0;
+	float error = 0.0f;
+	for (int stride = 1, level = 0; stride < size && level < MaxLevels;
+	     stride *= 2, level++) {
+		const int cells = CellCount(size, stride);
+		const int offset = pos;
+		for (int cz = 0; cz < cells; cz++) {
+			for (int cx = 0; cx < cells; cx++) {
+				const int x0 = cx * stride, z0 = cz * stride;
+				const int a = z0 * size + x0;
+				const int b = a + stride;
+				const int c = a + stride * size;
+				const int d = c + stride;
+
+				// Two triangles, split along the a-d diagonal, facing +Y.
+				const int cell[6] = {a, c, d, a, d, b};
+				for (int index : cell) {
+					indexes[pos++] = static_cast<unsigned short>(index);
+				}
+
+				// Measure how far the skipped vertexes are from the
+				// simplified surface.
+				const float ha = heights[a], hb = heights[b], hc = heights[c],
+							hd = heights[d];
+				const float scale = 1.0f / static_cast<float>(stride);
+				for (int z = 0; z <= stride; z++) {
+					for (int x = 0; x <= stride; x++) {
+						const float u = static_cast<float>(x) * scale;
+						const float v = static_cast<float>(z) * scale;
+						const float h =
+							v >= u ? ha * (1.0f - v) + hc * (v - u) + hd * u
+								   : ha * (1.0f - u) + hb * (u - v) + hd * v;
+						const float actual =
+							heights[(z0 + z) * size + (x0 + x)];
+						error = std::max(error, std::abs(actual - h));
+					}
+				}
+			}
+		}
+		chain->AddLevel(Level{offset, pos - offset, error});
+	}
+}
+
+} // namespace mesh
+} // namespace demo
@@ -0,0 +1,75 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include <array>
+#include <span>
+
+namespace demo {
+namespace mesh {
+
+// Maximum number of levels of detail for a single mesh.
+constexpr int MaxLevels = 8;
+
+// A single level of detail for a mesh. This is a range of indexes in the
+// mesh's index buffer.
+struct Level {
+	int offset;  // Offset of the first index, in indexes.
+	int count;   // Number of indexes.
+	float error; // Maximum geometric error, in object-space units.
+};
+
+// A chain of simplified index buffers for a mesh, sharing the same vertex
+// data. Level 0 is the most detailed. Each level after that is coarser and has
+// a larger error.
+class LODChain {
+public:
+	LODChain() : mLevelCount{0}, mLevels{} {}
+
+	int levelCount() const { return mLevelCount; }
+	const Level &level(int index) const { return mLevels[index]; }
+
+	// Add a level to the end of the chain.
+	void AddLevel(const Level &level);
+
+	// Select a level of detail. The errorScale converts object-space error to
+	// screen-space error in pixels, and threshold is the maximum acceptable
+	// screen-space error. The current level is used for hysteresis, so the
+	// level does not switch back and forth when the error is close to the
+	// threshold.
+	int Select(float errorScale, float threshold, int current) const;
+
+private:
+	int mLevelCount;
+	std::array<Level, MaxLevels> mLevels;
+};
+
+// Return the factor which converts object-space error at unit distance from
+// the camera to screen-space error in pixels, for a perspective projection
+// with the given vertical field of view (in radians).
+float PixelScale(float fovY, float viewportHeight);
+
+// Return the number of indexes required to store all levels of detail for a
+// grid mesh with the given number of vertexes on each side.
+constexpr int GridIndexCount(int size) {
+	int count = 0;
+	for (int stride = 1, level = 0; stride < size && level < MaxLevels;
+	     stride *= 2, level++) {
+		const int cells = (size - 1) / stride;
+		count += cells * cells * 6;
+	}
+	return count;
+}
+
+// Create a chain of levels of detail for a square grid of vertexes. The grid
+// has size*size vertexes in row-major order, and size-1 must be a power of
+// two. The heights are used to calculate the geometric error of each level.
+// Each coarser level skips every other row and column of vertexes from the
+// previous level. The indexes array must have room for GridIndexCount(size)
+// indexes. Indexes are for drawing GL_TRIANGLES.
+void BuildGrid(LODChain *chain, std::span<unsigned short> indexes, int size,
+               std::span<const float> heights);
+
+} // namespace mesh
+} // namespace demo
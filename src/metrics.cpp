@@ -0,0 +1,417 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "metrics.hpp"
+
+#include "log.hpp"
+#include "text_buffer.hpp"
+#include "var.hpp"
+
+#include <atomic>
+#include <bit>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <span>
+
+namespace demo {
+namespace metrics {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Maximum number of each kind of metric.
+constexpr int MaxCounters = 128;
+constexpr int MaxGauges = 64;
+constexpr int MaxHistograms = 16;
+
+// Number of frames in each report, when Metrics is set.
+constexpr int ReportFrames = 60;
+
+// Maximum number of metric attributes in one log record. The asynchronous log
+// keeps at most 32 attributes, and each record also has the frame count and
+// the group name.
+constexpr std::size_t MaxRecordMetrics = 30;
+
+// Quantiles reported for histograms.
+struct QuantileInfo {
+	std::string_view suffix;
+	double quantile;
+};
+
+// Constant initialized, so histograms can be declared in other files.
+constexpr QuantileInfo Quantiles[] = {
+	{".p50", 0.5},
+	{".p90", 0.9},
+	{".p99", 0.99},
+	{".max", 1.0},
+};
+
+constexpr int QuantileCount = std::size(Quantiles);
+
+// Names of the registered metrics.
+struct Registry {
+	std::mutex mutex;
+	std::vector<std::string_view> counters;
+	std::vector<std::string_view> gauges;
+	std::vector<std::string_view> histograms;
+	// Attribute names for histograms: the count, and then each quantile. A
+	// deque, so the strings do not move.
+	std::deque<std::string> histogramAttributes;
+};
+
+// Never deleted, since log records refer to the names by address.
+Registry &GetRegistry() {
+	static Registry *const registry = new Registry;
+	return *registry;
+}
+
+bool IsValidName(std::string_view name) {
+	if (name.empty()) {
+		return false;
+	}
+	for (const char c : name) {
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+		      (c >= '0' && c <= '9') || c == '_' || c == '.')) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int Register(std::vector<std::string_view> &names, std::string_view name,
+             int maxCount) {
+	if (!IsValidName(name)) {
+		FAIL("Invalid metric name.", log::Attr{"name", name});
+	}
+	if (static_cast<int>(names.size()) >= maxCount) {
+		FAIL("Too many metrics.", log::Attr{"name", name});
+	}
+	names.push_back(name);
+	return static_cast<int>(names.size()) - 1;
+}
+
+// Updates from one thread. Only that thread writes to it, so updates are a
+// relaxed load and store, not a read-modify-write. Other threads only read.
+struct ThreadData {
+	std::array<std::atomic<std::int64_t>, MaxCounters> counters;
+	std::array<std::array<std::atomic<std::uint64_t>, BucketCount>,
+	           MaxHistograms>
+		histograms;
+	// Next in the list of all threads.
+	ThreadData *next;
+};
+
+// List of all threads which have updated metrics. Entries are never removed,
+// so the counts from threads which exit are kept.
+std::atomic<ThreadData *> Threads;
+
+thread_local ThreadData *Local;
+
+ThreadData &GetLocal() {
+	if (Local == nullptr) {
+		ThreadData *const data = new ThreadData{};
+		data->next = Threads.load(std::memory_order_relaxed);
+		while (!Threads.compare_exchange_weak(data->next, data,
+		                                      std::memory_order_release,
+		                                      std::memory_order_relaxed)) {
+		}
+		Local = data;
+	}
+	return *Local;
+}
+
+template <typename T>
+void Increment(std::atomic<T> &value, T amount) {
+	value.store(value.load(std::memory_order_relaxed) + amount,
+	            std::memory_order_relaxed);
+}
+
+std::array<std::atomic<double>, MaxGauges> Gauges;
+
+int BucketIndex(std::uint64_t value) {
+	const int width = std::bit_width(value);
+	if (width <= 4) {
+		return static_cast<int>(value);
+	}
+	const int shift = width - 4;
+	return 16 + (shift - 1) * 8 + static_cast<int>((value >> shift) - 8);
+}
+
+// Get the value in the middle of a bucket.
+std::uint64_t BucketValue(int index) {
+	if (index < 16) {
+		return static_cast<std::uint64_t>(index);
+	}
+	const int shift = (index - 16) / 8 + 1;
+	const std::uint64_t low = static_cast<std::uint64_t>(8 + (index - 16) % 8)
+	                          << shift;
+	return low + (std::uint64_t{1} << (shift - 1));
+}
+
+// Log one group of metrics, in as many records as needed.
+void LogGroup(int frames, std::string_view group,
+              std::span<const log::Attr> attrs) {
+	for (std::size_t pos = 0; pos < attrs.size();) {
+		const std::size_t end =
+			std::min(attrs.size(), pos + MaxRecordMetrics);
+		log::Record record{log::Level::Info, LOG_LOCATION, "Metrics.",
+		                   log::Attr{"frames", frames},
+		                   log::Attr{"group", group}};
+		for (; pos < end; pos++) {
+			attrs[pos].AddToRecord(record);
+		}
+		// Several records per report come from this call site.
+		record.SetUnlimited();
+		record.Log();
+	}
+}
+
+// Totals as of the last frame, summed over threads.
+std::vector<std::int64_t> CounterTotals;
+std::vector<std::array<std::uint64_t, BucketCount>> HistogramTotals;
+
+Snapshot Frame;
+Snapshot Report;
+Clock::time_point LastFrameTime;
+
+Histogram FrameTime{"frame_us"};
+
+} // namespace
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+Counter::Counter(std::string_view name) {
+	Registry &registry = GetRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	mIndex = Register(registry.counters, name, MaxCounters);
+}
+
+void Counter::Add(std::int64_t value) {
+	Increment(GetLocal().counters[mIndex], value);
+}
+
+Gauge::Gauge(std::string_view name) {
+	Registry &registry = GetRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	mIndex = Register(registry.gauges, name, MaxGauges);
+}
+
+void Gauge::Set(double value) {
+	Gauges[mIndex].store(value, std::memory_order_relaxed);
+}
+
+Histogram::Histogram(std::string_view name) {
+	Registry &registry = GetRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	mIndex = Register(registry.histograms, name, MaxHistograms);
+	std::string attribute{name};
+	attribute.append(".count");
+	registry.histogramAttributes.push_back(std::move(attribute));
+	for (const QuantileInfo &info : Quantiles) {
+		attribute = name;
+		attribute.append(info.suffix);
+		registry.histogramAttributes.push_back(std::move(attribute));
+	}
+}
+
+void Histogram::Record(std::uint64_t value) {
+	Increment(GetLocal().histograms[mIndex][BucketIndex(value)],
+	          std::uint64_t{1});
+}
+
+// ============================================================================
+// Snapshot
+// ============================================================================
+
+std::uint64_t Snapshot::Quantile(int histogram, double quantile) const {
+	const std::array<std::uint64_t, BucketCount> &buckets =
+		mHistograms[histogram];
+	std::uint64_t count = 0;
+	for (const std::uint64_t n : buckets) {
+		count += n;
+	}
+	if (count == 0) {
+		return 0;
+	}
+	const std::uint64_t rank = std::max(
+		std::uint64_t{1},
+		static_cast<std::uint64_t>(std::ceil(quantile * count)));
+	std::uint64_t total = 0;
+	for (int i = 0; i < BucketCount; i++) {
+		total += buckets[i];
+		if (total >= rank) {
+			return BucketValue(i);
+		}
+	}
+	return BucketValue(BucketCount - 1);
+}
+
+void Snapshot::Log() const {
+	if (!log::IsEnabled(log::Level::Info)) {
+		return;
+	}
+	Registry &registry = GetRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	std::vector<log::Attr> attrs;
+	for (std::size_t i = 0; i < mCounters.size(); i++) {
+		attrs.emplace_back(registry.counters[i], mCounters[i]);
+	}
+	LogGroup(mFrames, "counters", attrs);
+	attrs.clear();
+	for (std::size_t i = 0; i < mGauges.size(); i++) {
+		attrs.emplace_back(registry.gauges[i], mGauges[i]);
+	}
+	LogGroup(mFrames, "gauges", attrs);
+	for (std::size_t i = 0; i < mHistograms.size(); i++) {
+		const std::size_t names = i * (QuantileCount + 1);
+		std::uint64_t count = 0;
+		for (const std::uint64_t n : mHistograms[i]) {
+			count += n;
+		}
+		attrs.clear();
+		attrs.emplace_back(registry.histogramAttributes[names], count);
+		for (int j = 0; j < QuantileCount; j++) {
+			attrs.emplace_back(
+				registry.histogramAttributes[names + j + 1],
+				Quantile(static_cast<int>(i), Quantiles[j].quantile));
+		}
+		LogGroup(mFrames, registry.histograms[i], attrs);
+	}
+}
+
+std::string Snapshot::ToJSON() const {
+	Registry &registry = GetRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	// Names are checked when registered, so they don't need escaping.
+	TextBuffer out;
+	out.Append("{\"frames\":");
+	out.AppendNumber(mFrames);
+	for (std::size_t i = 0; i < mCounters.size(); i++) {
+		out.Append(",\"");
+		out.Append(registry.counters[i]);
+		out.Append("\":");
+		out.AppendNumber(mCounters[i]);
+	}
+	for (std::size_t i = 0; i < mGauges.size(); i++) {
+		out.Append(",\"");
+		out.Append(registry.gauges[i]);
+		out.Append("\":");
+		if (std::isfinite(mGauges[i])) {
+			out.AppendNumber(mGauges[i]);
+		} else {
+			out.Append("null");
+		}
+	}
+	for (std::size_t i = 0; i < mHistograms.size(); i++) {
+		std::uint64_t count = 0;
+		for (const std::uint64_t n : mHistograms[i]) {
+			count += n;
+		}
+		out.Append(",\"");
+		out.Append(registry.histograms[i]);
+		out.Append("\":{\"count\":");
+		out.AppendNumber(count);
+		for (const QuantileInfo &info : Quantiles) {
+			out.Append(",\"");
+			out.Append(info.suffix.substr(1));
+			out.Append("\":");
+			out.AppendNumber(Quantile(static_cast<int>(i), info.quantile));
+		}
+		out.AppendChar('}');
+	}
+	out.AppendChar('}');
+	return std::string{out.Contents()};
+}
+
+// ============================================================================
+// Frames
+// ============================================================================
+
+void EndFrame() {
+	const Clock::time_point now = Clock::now();
+	if (LastFrameTime != Clock::time_point{}) {
+		FrameTime.Record(static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::microseconds>(
+				now - LastFrameTime)
+				.count()));
+	}
+	LastFrameTime = now;
+
+	std::size_t counterCount, gaugeCount, histogramCount;
+	{
+		Registry &registry = GetRegistry();
+		std::lock_guard<std::mutex> lock{registry.mutex};
+		counterCount = registry.counters.size();
+		gaugeCount = registry.gauges.size();
+		histogramCount = registry.histograms.size();
+	}
+
+	// Sum over threads, and subtract the last totals to get this frame.
+	std::vector<std::int64_t> counters(counterCount);
+	std::vector<std::array<std::uint64_t, BucketCount>> histograms(
+		histogramCount);
+	for (const ThreadData *data = Threads.load(std::memory_order_acquire);
+	     data != nullptr; data = data->next) {
+		for (std::size_t i = 0; i < counterCount; i++) {
+			counters[i] += data->counters[i].load(std::memory_order_relaxed);
+		}
+		for (std::size_t i = 0; i < histogramCount; i++) {
+			for (int j = 0; j < BucketCount; j++) {
+				histograms[i][j] +=
+					data->histograms[i][j].load(std::memory_order_relaxed);
+			}
+		}
+	}
+	CounterTotals.resize(counterCount);
+	HistogramTotals.resize(histogramCount);
+	Frame.mFrames = 1;
+	Frame.mCounters.resize(counterCount);
+	for (std::size_t i = 0; i < counterCount; i++) {
+		Frame.mCounters[i] = counters[i] - CounterTotals[i];
+	}
+	Frame.mGauges.resize(gaugeCount);
+	for (std::size_t i = 0; i < gaugeCount; i++) {
+		Frame.mGauges[i] = Gauges[i].load(std::memory_order_relaxed);
+	}
+	Frame.mHistograms.resize(histogramCount);
+	for (std::size_t i = 0; i < histogramCount; i++) {
+		for (int j = 0; j < BucketCount; j++) {
+			Frame.mHistograms[i][j] = histograms[i][j] - HistogramTotals[i][j];
+		}
+	}
+	CounterTotals = std::move(counters);
+	HistogramTotals = std::move(histograms);
+
+	if (!var::Metrics.get()) {
+		return;
+	}
+	Report.mFrames++;
+	Report.mCounters.resize(counterCount);
+	for (std::size_t i = 0; i < counterCount; i++) {
+		Report.mCounters[i] += Frame.mCounters[i];
+	}
+	Report.mGauges = Frame.mGauges;
+	Report.mHistograms.resize(histogramCount);
+	for (std::size_t i = 0; i < histogramCount; i++) {
+		for (int j = 0; j < BucketCount; j++) {
+			Report.mHistograms[i][j] += Frame.mHistograms[i][j];
+		}
+	}
+	if (Report.mFrames >= ReportFrames) {
+		Report.Log();
+		Report = Snapshot{};
+	}
+}
+
+const Snapshot &LastFrame() {
+	return Frame;
+}
+
+} // namespace metrics
+} // namespace demo
@@ -0,0 +1,109 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+// Metrics: named counters, gauges, and histograms, for numbers which change
+// every frame, like draw calls or upload sizes. Updates go to thread-local
+// storage without locks, and are merged once per frame. When the Metrics
+// variable is set, the totals are logged periodically.
+//
+// Metrics are declared as globals with string literal names, which must be
+// letters, digits, underscores, and periods:
+//
+//   metrics::Counter DrawCalls{"draw_calls"};
+//   DrawCalls.Add();
+
+#include "log.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace demo {
+namespace metrics {
+
+// Number of buckets in a histogram. Buckets are exact below 16, and above that
+// each power of two is divided into 8 buckets, so values are accurate to
+// within 1/16.
+constexpr int BucketCount = 496;
+
+// A count of events, like draw calls or bytes uploaded.
+class Counter {
+public:
+	explicit Counter(std::string_view name);
+	Counter(const Counter &) = delete;
+	Counter &operator=(const Counter &) = delete;
+
+	void Add(std::int64_t value = 1);
+
+private:
+	int mIndex;
+};
+
+// A value which is set, like the number of loaded textures. The last value
+// set from any thread wins.
+class Gauge {
+public:
+	explicit Gauge(std::string_view name);
+	Gauge(const Gauge &) = delete;
+	Gauge &operator=(const Gauge &) = delete;
+
+	void Set(double value);
+
+private:
+	int mIndex;
+};
+
+// A distribution of values, like frame times in microseconds.
+class Histogram {
+public:
+	explicit Histogram(std::string_view name);
+	Histogram(const Histogram &) = delete;
+	Histogram &operator=(const Histogram &) = delete;
+
+	void Record(std::uint64_t value);
+
+private:
+	int mIndex;
+};
+
+// Metric values over some number of frames. Counters and histograms are the
+// changes over those frames, and gauges are the last values.
+class Snapshot {
+public:
+	Snapshot() = default;
+
+	int frames() const { return mFrames; }
+
+	// Get a value at the given quantile, from 0 to 1, of a histogram.
+	std::uint64_t Quantile(int histogram, double quantile) const;
+
+	// Log the metrics, with one record for the counters, one for the gauges,
+	// and one for each histogram, which has its count and several quantiles.
+	// Groups which are too large for one record are split.
+	void Log() const;
+
+	// Format the metrics as a JSON object.
+	std::string ToJSON() const;
+
+private:
+	friend void EndFrame();
+
+	int mFrames = 0;
+	std::vector<std::int64_t> mCounters;
+	std::vector<double> mGauges;
+	std::vector<std::array<std::uint64_t, BucketCount>> mHistograms;
+};
+
+// Merge the updates from each thread, and record the frame time. Call once per
+// frame.
+void EndFrame();
+
+// Get the metrics for the last frame.
+const Snapshot &LastFrame();
+
+} // namespace metrics
+} // namespace demo
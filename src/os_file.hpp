@@ -3,6 +3,9 @@
 // SPDX-License-Identifier: MPL-2.0
 #pragma once
 
+#include "os_string.hpp"
+
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -11,4 +14,15 @@ namespace demo {
 // Read a file into memory.
 bool ReadFile(std::vector<unsigned char> *data, std::string_view fileName);
 
+// Read a file into memory, given its full path. Returns false if the file does
+// not exist, without logging an error.
+bool ReadFileIfExists(std::vector<unsigned char> *data, const os_string &path);
+
+// Write a file, given its full path. The data is written to a temporary file
+// which is then renamed, so the file is replaced atomically.
+bool WriteFile(const os_string &path, std::span<const unsigned char> data);
+
+// Create a directory, given its full path, if it does not already exist.
+bool MakeDirectory(const os_string &path);
+
 } // namespace demo
@@ -7,7 +7,9 @@
 #include "os_unix.hpp"
 #include "var.hpp"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -18,16 +20,13 @@ namespace {
 // Limit on maximum file size when reading files into memory.
 constexpr std::size_t MaxFileSize = 64 * 1024 * 1024;
 
-} // namespace
-
-bool ReadFile(std::vector<unsigned char> *data, std::string_view fileName) {
-	if (var::ProjectPath.empty()) {
-		FAIL("Project path is not set.");
-	}
-	std::string path{var::ProjectPath};
-	AppendPath(&path, fileName);
-	const int fd = ::open(path.c_str(), O_RDONLY);
+bool ReadFileImpl(std::vector<unsigned char> *data, std::string_view fileName,
+                  const char *fullPath, bool mustExist) {
+	const int fd = ::open(fullPath, O_RDONLY);
 	if (fd == -1) {
+		if (!mustExist && errno == ENOENT) {
+			return false;
+		}
 		LOG(Error, "Could not open file.", log::Attr{"file", fileName},
 		    UnixError::Get());
 		return false;
@@ -65,4 +64,67 @@ bool ReadFile(std::vector<unsigned char> *data, std::string_view fileName) {
 	return true;
 }
 
+} // namespace
+
+bool ReadFile(std::vector<unsigned char> *data, std::string_view fileName) {
+	std::string path{var::ProjectPath.get()};
+	if (path.empty()) {
+		FAIL("Project path is not set.");
+	}
+	AppendPath(&path, fileName);
+	return ReadFileImpl(data, fileName, path.c_str(), true);
+}
+
+bool ReadFileIfExists(std::vector<unsigned char> *data, const os_string &path) {
+	return ReadFileImpl(data, path, path.c_str(), false);
+}
+
+bool WriteFile(const os_string &path, std::span<const unsigned char> data) {
+	std::string temp{path};
+	temp.append(".tmp");
+	const int fd =
+		::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd == -1) {
+		LOG(Error, "Could not create file.", log::Attr{"file", temp},
+		    UnixError::Get());
+		return false;
+	}
+	for (std::size_t pos = 0; pos < data.size();) {
+		const ssize_t amt = ::write(fd, data.data() + pos, data.size() - pos);
+		if (amt < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			LOG(Error, "Could not write file.", log::Attr{"file", temp},
+			    UnixError::Get());
+			::close(fd);
+			::unlink(temp.c_str());
+			return false;
+		}
+		pos += amt;
+	}
+	if (::close(fd) != 0) {
+		LOG(Error, "Could not write file.", log::Attr{"file", temp},
+		    UnixError::Get());
+		::unlink(temp.c_str());
+		return false;
+	}
+	if (::rename(temp.c_str(), path.c_str()) != 0) {
+		LOG(Error, "Could not rename file.", log::Attr{"file", path},
+		    UnixError::Get());
+		::unlink(temp.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool MakeDirectory(const os_string &path) {
+	if (::mkdir(path.c_str(), 0777) != 0 && errno != EEXIST) {
+		LOG(Error, "Could not create directory.", log::Attr{"path", path},
+		    UnixError::Get());
+		return false;
+	}
+	return true;
+}
+
 } // namespace demo
@@ -12,11 +12,17 @@ namespace {
 // Limit on maximum file size when reading files into memory.
 constexpr std::size_t MaxFileSize = 64 * 1024 * 1024;
 
-bool ReadFileImpl(std::vector<unsigned char> *data, std::string_view fileName,
-                  const wchar_t *fullPath) {
+template <typename Name>
+bool ReadFileImpl(std::vector<unsigned char> *data, const Name &fileName,
+                  const wchar_t *fullPath, bool mustExist) {
 	HANDLE h = CreateFileW(fullPath, FILE_READ_DATA, FILE_SHARE_READ, nullptr,
 	                       OPEN_EXISTING, 0, nullptr);
 	if (h == INVALID_HANDLE_VALUE) {
+		const DWORD error = GetLastError();
+		if (!mustExist && (error == ERROR_FILE_NOT_FOUND ||
+		                   error == ERROR_PATH_NOT_FOUND)) {
+			return false;
+		}
 		LOG(Error, "Could not open file.", log::Attr{"file", fileName},
 		    WindowsError::GetLast());
 		return false;
@@ -66,7 +72,7 @@ bool ReadFile(std::vector<unsigned char> *data, std::string_view fileName) {
 		FAIL("Character conversion failed.");
 	}
 	buffer[count] = L'\0';
-	return ReadFileImpl(data, fileName, buffer);
+	return ReadFileImpl(data, fileName, buffer, true);
 }
 
 } // namespace demo
@@ -83,7 +89,57 @@ bool ReadFile(std::vector<unsigned char> *data, std::string_view fileName) {
 		FAIL("Project path is not set.");
 	}
 	AppendPath(&path, fileName);
-	return ReadFileImpl(data, fileName, path.c_str());
+	return ReadFileImpl(data, fileName, path.c_str(), true);
+}
+
+bool ReadFileIfExists(std::vector<unsigned char> *data, const os_string &path) {
+	return ReadFileImpl(data, path, path.c_str(), false);
+}
+
+bool WriteFile(const os_string &path, std::span<const unsigned char> data) {
+	std::wstring temp{path};
+	temp.append(L".tmp");
+	if (data.size() > MaxFileSize) {
+		LOG(Error, "File is too large.", log::Attr{"file", path},
+		    log::Attr{"size", data.size()}, log::Attr{"maxSize", MaxFileSize});
+		return false;
+	}
+	HANDLE h = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, nullptr,
+	                       CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (h == INVALID_HANDLE_VALUE) {
+		LOG(Error, "Could not create file.", log::Attr{"file", temp},
+		    WindowsError::GetLast());
+		return false;
+	}
+	DWORD nBytesWritten;
+	const BOOL ok = ::WriteFile(h, data.data(), static_cast<DWORD>(data.size()),
+	                            &nBytesWritten, nullptr);
+	if (!ok) {
+		LOG(Error, "Could not write file.", log::Attr{"file", temp},
+		    WindowsError::GetLast());
+	}
+	CloseHandle(h);
+	if (!ok) {
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+	if (!MoveFileExW(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		LOG(Error, "Could not rename file.", log::Attr{"file", path},
+		    WindowsError::GetLast());
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool MakeDirectory(const os_string &path) {
+	if (!CreateDirectoryW(path.c_str(), nullptr) &&
+	    GetLastError() != ERROR_ALREADY_EXISTS) {
+		LOG(Error, "Could not create directory.", log::Attr{"path", path},
+		    WindowsError::GetLast());
+		return false;
+	}
+	return true;
 }
 
 } // namespace demo
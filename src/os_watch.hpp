@@ -0,0 +1,56 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if _WIN32
+#include <memory>
+#endif
+
+namespace demo {
+
+// Watches a directory for files which are modified. This uses inotify on Linux
+// and ReadDirectoryChangesW on Windows. On other platforms, Init logs that
+// watching is not supported and returns false, and Poll reports no changes.
+class DirectoryWatcher {
+public:
+#if _WIN32
+	DirectoryWatcher() : mState{} {}
+#else
+	DirectoryWatcher() : mHandle{-1} {}
+#endif
+	DirectoryWatcher(const DirectoryWatcher &) = delete;
+	DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+	~DirectoryWatcher();
+
+	// Start watching a directory, relative to the project path. Return false
+	// if the directory cannot be watched.
+	bool Init(std::string_view directoryName);
+
+	// Return true if the directory is being watched.
+#if _WIN32
+	bool IsActive() const { return mState != nullptr; }
+#else
+	bool IsActive() const { return mHandle != -1; }
+#endif
+
+	// Get the names of files in the directory which were modified since the
+	// last call. Does not block.
+	void Poll(std::vector<std::string> *changed);
+
+private:
+#if _WIN32
+	struct State;
+	// The directory handle and pending read, or null if not watching.
+	std::unique_ptr<State> mState;
+#else
+	// The inotify file descriptor, or -1 if not watching.
+	int mHandle;
+#endif
+};
+
+} // namespace demo
@@ -0,0 +1,113 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "os_watch.hpp"
+
+#include "log.hpp"
+
+#if __linux__
+
+#include "os_unix.hpp"
+#include "var.hpp"
+
+#include <algorithm>
+
+#include <errno.h>
+#include <sys/inotify.h>
+
+namespace demo {
+
+DirectoryWatcher::~DirectoryWatcher() {
+	if (mHandle != -1) {
+		::close(mHandle);
+	}
+}
+
+bool DirectoryWatcher::Init(std::string_view directoryName) {
+	std::string path{var::ProjectPath.get()};
+	if (path.empty()) {
+		FAIL("Project path is not set.");
+	}
+	AppendPath(&path, directoryName);
+	const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd == -1) {
+		LOG(Error, "Could not create inotify instance.", UnixError::Get());
+		return false;
+	}
+	// Editors either write the file in place, or write a temporary file and
+	// rename it over the original.
+	if (inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) ==
+	    -1) {
+		LOG(Error, "Could not watch directory.",
+		    log::Attr{"directory", directoryName}, UnixError::Get());
+		::close(fd);
+		return false;
+	}
+	mHandle = fd;
+	return true;
+}
+
+void DirectoryWatcher::Poll(std::vector<std::string> *changed) {
+	changed->clear();
+	if (mHandle == -1) {
+		return;
+	}
+	alignas(inotify_event) char buffer[4096];
+	for (;;) {
+		const ssize_t amt = ::read(mHandle, buffer, sizeof(buffer));
+		if (amt < 0) {
+			const int error = errno;
+			if (error == EINTR) {
+				continue;
+			}
+			if (error != EAGAIN && error != EWOULDBLOCK) {
+				LOG(Error, "Could not read file change events.",
+				    UnixError{error});
+				::close(mHandle);
+				mHandle = -1;
+			}
+			return;
+		}
+		if (amt == 0) {
+			return;
+		}
+		for (const char *ptr = buffer, *end = buffer + amt; ptr < end;) {
+			const inotify_event *event =
+				reinterpret_cast<const inotify_event *>(ptr);
+			if ((event->mask & IN_Q_OVERFLOW) != 0) {
+				LOG(Warn, "File change events were lost.");
+			}
+			if (event->len > 0) {
+				// The name is padded with null bytes.
+				const std::string_view name{event->name};
+				if (std::find(changed->begin(), changed->end(), name) ==
+				    changed->end()) {
+					changed->emplace_back(name);
+				}
+			}
+			ptr += sizeof(inotify_event) + event->len;
+		}
+	}
+}
+
+} // namespace demo
+
+#else
+
+namespace demo {
+
+DirectoryWatcher::~DirectoryWatcher() {}
+
+bool DirectoryWatcher::Init(std::string_view directoryName) {
+	LOG(Info, "Watching for file changes is not supported on this platform.",
+	    log::Attr{"directory", directoryName});
+	return false;
+}
+
+void DirectoryWatcher::Poll(std::vector<std::string> *changed) {
+	changed->clear();
+}
+
+} // namespace demo
+
+#endif
@@ -0,0 +1,143 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "os_watch.hpp"
+
+#include "log.hpp"
+#include "os_windows.hpp"
+#include "var.hpp"
+
+#include <algorithm>
+
+namespace demo {
+
+// A directory handle with an overlapped read of change events. The read is
+// always pending while watching, so the system buffers events between polls.
+struct DirectoryWatcher::State {
+	State()
+		: directory{INVALID_HANDLE_VALUE},
+		  overlapped{},
+		  reading{false},
+		  buffer{} {}
+	State(const State &) = delete;
+	State &operator=(const State &) = delete;
+	~State();
+
+	// Start reading the next batch of change events. Return false on error.
+	bool Read();
+
+	HANDLE directory;
+	OVERLAPPED overlapped;
+	// True if a read was started and has not completed.
+	bool reading;
+	// Change records. FILE_NOTIFY_INFORMATION must be DWORD-aligned.
+	alignas(DWORD) unsigned char buffer[16 * 1024];
+};
+
+DirectoryWatcher::State::~State() {
+	if (reading) {
+		// Wait for the cancelled read, since it writes to the buffer.
+		DWORD amt;
+		CancelIoEx(directory, &overlapped);
+		GetOverlappedResult(directory, &overlapped, &amt, TRUE);
+	}
+	if (directory != INVALID_HANDLE_VALUE) {
+		CloseHandle(directory);
+	}
+	if (overlapped.hEvent != nullptr) {
+		CloseHandle(overlapped.hEvent);
+	}
+}
+
+bool DirectoryWatcher::State::Read() {
+	// Editors either write the file in place, or write a temporary file and
+	// rename it over the original.
+	constexpr DWORD filter =
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+	reading = ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE,
+	                                filter, nullptr, &overlapped,
+	                                nullptr) != 0;
+	return reading;
+}
+
+DirectoryWatcher::~DirectoryWatcher() {}
+
+bool DirectoryWatcher::Init(std::string_view directoryName) {
+	std::wstring path{var::ProjectPath.get()};
+	if (path.empty()) {
+		FAIL("Project path is not set.");
+	}
+	AppendPath(&path, directoryName);
+	std::unique_ptr<State> state{new State};
+	state->directory = CreateFileW(
+		path.c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		nullptr);
+	if (state->directory == INVALID_HANDLE_VALUE) {
+		LOG(Error, "Could not open directory.",
+		    log::Attr{"directory", directoryName}, WindowsError::GetLast());
+		return false;
+	}
+	state->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (state->overlapped.hEvent == nullptr) {
+		LOG(Error, "Could not create event.", WindowsError::GetLast());
+		return false;
+	}
+	if (!state->Read()) {
+		LOG(Error, "Could not watch directory.",
+		    log::Attr{"directory", directoryName}, WindowsError::GetLast());
+		return false;
+	}
+	mState = std::move(state);
+	return true;
+}
+
+void DirectoryWatcher::Poll(std::vector<std::string> *changed) {
+	changed->clear();
+	while (mState != nullptr) {
+		State &state = *mState;
+		DWORD amt;
+		if (!GetOverlappedResult(state.directory, &state.overlapped, &amt,
+		                         FALSE)) {
+			const DWORD error = GetLastError();
+			if (error != ERROR_IO_INCOMPLETE) {
+				state.reading = false;
+				LOG(Error, "Could not read file change events.",
+				    WindowsError{error});
+				mState.reset();
+			}
+			return;
+		}
+		state.reading = false;
+		if (amt == 0) {
+			// The system's buffer overflowed.
+			LOG(Warn, "File change events were lost.");
+		}
+		for (DWORD pos = 0; pos < amt;) {
+			const FILE_NOTIFY_INFORMATION *info =
+				reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(
+					state.buffer + pos);
+			if (info->Action != FILE_ACTION_REMOVED &&
+			    info->Action != FILE_ACTION_RENAMED_OLD_NAME) {
+				const std::string name = ToString(
+					{info->FileName, info->FileNameLength / sizeof(wchar_t)});
+				if (std::find(changed->begin(), changed->end(), name) ==
+				    changed->end()) {
+					changed->push_back(name);
+				}
+			}
+			if (info->NextEntryOffset == 0) {
+				break;
+			}
+			pos += info->NextEntryOffset;
+		}
+		if (!state.Read()) {
+			LOG(Error, "Could not read file change events.",
+			    WindowsError::GetLast());
+			mState.reset();
+		}
+	}
+}
+
+} // namespace demo
@@ -0,0 +1,243 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+
+// Replay benchmark. Plays back an OpenGL trace recorded with the GLTrace
+// variable, and measures how long each frame takes. This lets rendering
+// changes be benchmarked without the rest of the program.
+//
+// The first frame contains all of the setup calls and is played once. The
+// remaining frames are played ReplayPasses times. Resources created in those
+// frames are created again on each pass, and are not deleted.
+
+#include "gl.hpp"
+#include "gl_trace.hpp"
+#include "log.hpp"
+#include "main.hpp"
+#include "os_file.hpp"
+#include "var.hpp"
+
+#define GLFW_INCLUDE_NONE
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace demo {
+namespace {
+
+#if !GL_TRACE
+#error "Replay requires OpenGL bindings generated with --trace."
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int Width = 1280;
+constexpr int Height = 720;
+
+// Number of passes, if ReplayPasses is not set.
+constexpr int DefaultPasses = 10;
+
+double ToMilliseconds(Clock::duration time) {
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+// A trace loaded into memory.
+struct Trace {
+	std::vector<std::uint64_t> data;
+	// Replay function for each function index in the trace.
+	std::vector<gl_trace::ReplayFunction> functions;
+	// Position of the first call after the header.
+	std::size_t start;
+};
+
+// Map the function names in the trace to the functions in this build.
+void LoadFunctions(Trace &trace, gl_trace::Reader &reader) {
+	std::unordered_map<std::string_view, int> indexes;
+	const char *namePtr = gl_api::FunctionNames;
+	for (int i = 0; i < gl_api::FunctionPointerCount; i++) {
+		const std::string_view name{namePtr};
+		indexes.emplace(name, i);
+		namePtr += name.size() + 1;
+	}
+
+	const std::uint64_t count = reader.Next();
+	std::size_t size;
+	const char *names = static_cast<const char *>(reader.Data(&size));
+	if (names == nullptr || size == 0 || names[size - 1] != '\0') {
+		FAIL("Invalid OpenGL trace header.");
+	}
+	const char *const end = names + size;
+	for (std::uint64_t i = 0; i < count; i++) {
+		if (names == end) {
+			FAIL("Invalid OpenGL trace header.");
+		}
+		const std::string_view name{names};
+		names += name.size() + 1;
+		gl_trace::ReplayFunction function = nullptr;
+		const auto it = indexes.find(name);
+		if (it != indexes.end()) {
+			function = gl_api::ReplayFunctions[it->second];
+		}
+		trace.functions.push_back(function);
+	}
+}
+
+Trace LoadTrace() {
+	const os_string path{var::GLTrace.get()};
+	if (path.empty()) {
+		FAIL("No trace specified. Set GLTrace to the path of a trace.");
+	}
+	std::vector<unsigned char> bytes;
+	if (!ReadFileIfExists(&bytes, path)) {
+		FAIL("Trace does not exist.", log::Attr{"path", path});
+	}
+	if (bytes.size() % sizeof(std::uint64_t) != 0) {
+		FAIL("Invalid OpenGL trace size.", log::Attr{"path", path});
+	}
+	Trace trace;
+	trace.data.resize(bytes.size() / sizeof(std::uint64_t));
+	std::memcpy(trace.data.data(), bytes.data(), bytes.size());
+	gl_trace::Reader reader{trace.data};
+	if (trace.data.empty() || reader.Next() != gl_trace::Magic) {
+		FAIL("File is not an OpenGL trace.", log::Attr{"path", path});
+	}
+	LoadFunctions(trace, reader);
+	trace.start = reader.position();
+	return trace;
+}
+
+// Replay calls until the end of the frame. Returns false at the end of the
+// trace.
+bool ReplayFrame(const Trace &trace, gl_trace::Reader &reader) {
+	while (!reader.AtEnd()) {
+		const std::uint64_t index = reader.Next();
+		if (index == gl_trace::EndFrameMarker) {
+			return true;
+		}
+		if (index >= trace.functions.size()) {
+			FAIL("Invalid function in OpenGL trace.",
+			     log::Attr{"index", static_cast<double>(index)});
+		}
+		const gl_trace::ReplayFunction function = trace.functions[index];
+		if (function == nullptr) {
+			FAIL("OpenGL trace contains a call which cannot be replayed.",
+			     log::Attr{"index", static_cast<double>(index)});
+		}
+		function(reader);
+	}
+	return false;
+}
+
+void Main() {
+	log::Init();
+	const Trace trace = LoadTrace();
+
+	if (!glfwInit()) {
+		FAIL("Could not initialize GLFW.");
+	}
+	// Same context as the demo, but hidden and without vsync.
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow *window =
+		glfwCreateWindow(Width, Height, "Replay", nullptr, nullptr);
+	if (window == nullptr) {
+		FAIL("Could not create window.");
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	gl_api::LoadProcs();
+	gl_api::LoadExtensions();
+
+	// Play the setup frame, and find where the other frames start.
+	gl_trace::Reader reader{trace.data};
+	reader.set_position(trace.start);
+	ReplayFrame(trace, reader);
+	glFinish();
+	std::vector<std::size_t> frames;
+	for (;;) {
+		const std::size_t pos = reader.position();
+		if (!ReplayFrame(trace, reader)) {
+			break;
+		}
+		frames.push_back(pos);
+	}
+	glFinish();
+	if (frames.empty()) {
+		FAIL("OpenGL trace has no frames to benchmark.");
+	}
+
+	const int passCount = var::ReplayPasses.get() > 0
+	                          ? var::ReplayPasses.get()
+	                          : DefaultPasses;
+	const double frameCount = static_cast<double>(frames.size());
+	double bestCPU = 0.0, bestTotal = 0.0;
+	for (int pass = 0; pass < passCount; pass++) {
+		// CPU time is the time to submit the calls. Total time includes
+		// waiting for the GPU to finish.
+		Clock::duration cpu{};
+		const Clock::time_point passStart = Clock::now();
+		for (const std::size_t pos : frames) {
+			const Clock::time_point frameStart = Clock::now();
+			reader.set_position(pos);
+			ReplayFrame(trace, reader);
+			cpu += Clock::now() - frameStart;
+			glfwSwapBuffers(window);
+		}
+		glFinish();
+		const Clock::duration total = Clock::now() - passStart;
+		const double cpuMS = ToMilliseconds(cpu) / frameCount;
+		const double totalMS = ToMilliseconds(total) / frameCount;
+		LOG(Info, "Replay pass.", log::Attr{"pass", pass},
+		    log::Attr{"frames", static_cast<int>(frames.size())},
+		    log::Attr{"cpu_ms", cpuMS}, log::Attr{"total_ms", totalMS});
+		if (pass == 0 || totalMS < bestTotal) {
+			bestTotal = totalMS;
+		}
+		if (pass == 0 || cpuMS < bestCPU) {
+			bestCPU = cpuMS;
+		}
+	}
+	LOG(Info, "Replay finished.", log::Attr{"passes", passCount},
+	    log::Attr{"best_cpu_ms", bestCPU},
+	    log::Attr{"best_total_ms", bestTotal});
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+}
+
+} // namespace
+
+[[noreturn]]
+void ExitError() {
+	glfwTerminate();
+	std::exit(1);
+}
+
+} // namespace demo
+
+#if _WIN32
+
+int wmain(int argc, wchar_t **argv) {
+	demo::ParseCommandArguments(argc - 1, argv + 1);
+	demo::Main();
+	return 0;
+}
+
+#else
+
+int main(int argc, char **argv) {
+	demo::ParseCommandArguments(argc - 1, argv + 1);
+	demo::Main();
+	return 0;
+}
+
+#endif
@@ -4,6 +4,10 @@
 #include "scene_cube.hpp"
 
 #include "gl_shader.hpp"
+#if !COMPO
+#include "metrics.hpp"
+#include "var.hpp"
+#endif
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -19,6 +23,12 @@ namespace scene {
 
 namespace {
 
+namespace shader = gl_shader::Cube;
+
+#if !COMPO
+metrics::Counter Draws{"cube.draws"};
+#endif
+
 constexpr float Aspect = 16.0f / 9.0f;
 
 struct Vertex {
@@ -68,6 +78,26 @@ const unsigned short IndexData[6 * 4 + 5] = {
 	20, 21, 22, 23          //
 };
 
+// Use the cube program and set its uniforms.
+void UseProgram(const glm::mat4 &mvp) {
+#if !COMPO
+	if (var::CubeFog.get()) {
+		// The fog variant is compiled on first use. Until it is ready, draw
+		// with the base program.
+		gl_shader::Variant *const variant =
+			gl_shader::GetVariant(shader::Program, shader::feature::FOG(1));
+		if (variant != nullptr) {
+			glUseProgram(variant->program);
+			gl_shader::SetUniformMatrix4fv(variant, shader::uniform::MVP,
+			                               glm::value_ptr(mvp));
+			return;
+		}
+	}
+#endif
+	glUseProgram(gl_shader::Programs[shader::Program]);
+	gl_shader::SetUniformMatrix4fv(shader::uniform::MVP, glm::value_ptr(mvp));
+}
+
 } // namespace
 
 void Cube::Init() {
@@ -77,12 +107,12 @@ void Cube::Init() {
 	glBindBuffer(GL_ARRAY_BUFFER, mBuffer[0]);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData), VertexData,
 	             GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_SHORT, GL_FALSE, sizeof(Vertex),
-	                      reinterpret_cast<void *>(0));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
-	                      reinterpret_cast<void *>(8));
+	glEnableVertexAttribArray(shader::attrib::Vertex);
+	glVertexAttribPointer(shader::attrib::Vertex, 3, GL_SHORT, GL_FALSE,
+	                      sizeof(Vertex), reinterpret_cast<void *>(0));
+	glEnableVertexAttribArray(shader::attrib::Color);
+	glVertexAttribPointer(shader::attrib::Color, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+	                      sizeof(Vertex), reinterpret_cast<void *>(8));
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mBuffer[1]);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(IndexData), IndexData,
 	             GL_STATIC_DRAW);
@@ -106,13 +136,15 @@ void Cube::Render(double time) {
 	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glUseProgram(gl_shader::CubeProgram);
-	glUniformMatrix4fv(gl_shader::MVP, 1, GL_FALSE, glm::value_ptr(mvp));
+	UseProgram(mvp);
 	glPrimitiveRestartIndex(0xffff);
 	glEnable(GL_PRIMITIVE_RESTART);
 	glEnable(GL_CULL_FACE);
 	glDrawElements(GL_TRIANGLE_STRIP, std::size(IndexData), GL_UNSIGNED_SHORT,
 	               reinterpret_cast<void *>(0));
+#if !COMPO
+	Draws.Add();
+#endif
 }
 
 } // namespace scene
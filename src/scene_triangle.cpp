@@ -13,6 +13,8 @@ namespace scene {
 
 namespace {
 
+namespace shader = gl_shader::Triangle;
+
 constexpr float InverseAspect = 480.0f / 640.0f;
 constexpr float TriangleSize = 0.8f;
 
@@ -34,8 +36,8 @@ void Triangle::Init() {
 	glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData), VertexData,
 	             GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8, 0);
+	glEnableVertexAttribArray(shader::attrib::Vertex);
+	glVertexAttribPointer(shader::attrib::Vertex, 2, GL_FLOAT, GL_FALSE, 8, 0);
 }
 
 void Triangle::Render(double time) {
@@ -47,7 +49,7 @@ void Triangle::Render(double time) {
 	             0.5f + 0.5f * std::sin(a - d), 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glUseProgram(demo::gl_shader::TriangleProgram);
+	glUseProgram(gl_shader::Programs[shader::Program]);
 	glDrawArrays(GL_TRIANGLES, 0, 3);
 }
 
@@ -0,0 +1,154 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "scene_waves.hpp"
+
+#include "gl_shader.hpp"
+#include "metrics.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace demo {
+namespace scene {
+
+namespace {
+
+namespace shader = gl_shader::Cube;
+
+metrics::Counter Draws{"waves.draws"};
+metrics::Counter Triangles{"waves.triangles"};
+
+constexpr float Aspect = 16.0f / 9.0f;
+constexpr float FieldOfView = std::numbers::pi_v<float> * 0.25f;
+constexpr float NearPlane = 0.1f;
+
+// Maximum acceptable screen-space error, in pixels.
+constexpr float ErrorThreshold = 1.0f;
+
+// Number of vertexes along each side of a patch.
+constexpr int GridSize = 65;
+// Width of a patch, in object-space units.
+constexpr float PatchSize = 2.0f;
+// Maximum height of the waves.
+constexpr float Amplitude = 0.15f;
+// Radius of a sphere which contains a patch.
+const float PatchRadius =
+	std::sqrt(2.0f * (PatchSize * 0.5f) * (PatchSize * 0.5f) +
+              Amplitude * Amplitude);
+
+struct Vertex {
+	float pos[3];
+	unsigned char color[4];
+};
+
+float Heights[GridSize * GridSize];
+Vertex VertexData[GridSize * GridSize];
+unsigned short IndexData[mesh::GridIndexCount(GridSize)];
+
+// Procedural wave height, for coordinates in the range [0,1].
+float WaveHeight(float u, float v) {
+	constexpr float tau = 2.0f * std::numbers::pi_v<float>;
+	const float h = std::sin(u * tau) * std::cos(v * tau) +
+	                0.5f * std::sin((u + v) * 2.0f * tau) +
+	                0.25f * std::cos((u - 2.0f * v) * 3.0f * tau);
+	return h * (Amplitude / 1.75f);
+}
+
+unsigned char Mix(int a, int b, float t) {
+	return static_cast<unsigned char>(
+		static_cast<float>(a) + (static_cast<float>(b - a) * t));
+}
+
+} // namespace
+
+void Waves::Init() {
+	const float scale = 1.0f / static_cast<float>(GridSize - 1);
+	for (int z = 0; z < GridSize; z++) {
+		for (int x = 0; x < GridSize; x++) {
+			const float u = static_cast<float>(x) * scale;
+			const float v = static_cast<float>(z) * scale;
+			const float h = WaveHeight(u, v);
+			const float t =
+				std::clamp(h * (0.5f / Amplitude) + 0.5f, 0.0f, 1.0f);
+			const int index = z * GridSize + x;
+			Heights[index] = h;
+			VertexData[index] = Vertex{
+				{(u - 0.5f) * PatchSize, h, (v - 0.5f) * PatchSize},
+				{Mix(0x1d, 0x29, t), Mix(0x2b, 0xad, t), Mix(0x53, 0xff, t),
+			     0xff},
+			};
+		}
+	}
+	mesh::BuildGrid(&mChain, IndexData, GridSize, Heights);
+
+	glGenVertexArrays(1, &mArray);
+	glBindVertexArray(mArray);
+	glGenBuffers(2, mBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, mBuffer[0]);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData), VertexData,
+	             GL_STATIC_DRAW);
+	glEnableVertexAttribArray(shader::attrib::Vertex);
+	glVertexAttribPointer(shader::attrib::Vertex, 3, GL_FLOAT, GL_FALSE,
+	                      sizeof(Vertex), reinterpret_cast<void *>(0));
+	glEnableVertexAttribArray(shader::attrib::Color);
+	glVertexAttribPointer(shader::attrib::Color, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+	                      sizeof(Vertex), reinterpret_cast<void *>(12));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mBuffer[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(IndexData), IndexData,
+	             GL_STATIC_DRAW);
+}
+
+void Waves::Render(double time, int height) {
+	const float fTime =
+		static_cast<float>(std::fmod(time, 4.0 * std::numbers::pi));
+	const glm::mat4 projection =
+		glm::perspective(FieldOfView, Aspect, NearPlane, 100.0f);
+	const glm::vec3 eye{0.5f * std::sin(fTime * 0.5f), 1.5f, 2.0f};
+	const glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, -6.0f),
+	                                   glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 viewProjection = projection * view;
+	const float pixelScale =
+		mesh::PixelScale(FieldOfView, static_cast<float>(height));
+
+	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glUseProgram(gl_shader::Programs[shader::Program]);
+	glBindVertexArray(mArray);
+	glEnable(GL_CULL_FACE);
+
+	// Draw from back to front, since there is no depth buffer.
+	for (int row = FieldSize - 1; row >= 0; row--) {
+		for (int column = 0; column < FieldSize; column++) {
+			const glm::vec3 center{
+				(static_cast<float>(column) - 0.5f * (FieldSize - 1)) *
+					PatchSize,
+				0.0f, -static_cast<float>(row) * PatchSize};
+			const float distance = std::max(
+				glm::length(center - eye) - PatchRadius, NearPlane);
+			int &level = mLevel[row * FieldSize + column];
+			level =
+				mChain.Select(pixelScale / distance, ErrorThreshold, level);
+			const mesh::Level &lod = mChain.level(level);
+
+			const glm::mat4 mvp =
+				viewProjection * glm::translate(glm::mat4(1.0f), center);
+			gl_shader::SetUniformMatrix4fv(shader::uniform::MVP,
+			                               glm::value_ptr(mvp));
+			glDrawElements(GL_TRIANGLES, lod.count, GL_UNSIGNED_SHORT,
+			               reinterpret_cast<void *>(
+							   lod.offset * sizeof(unsigned short)));
+			Draws.Add();
+			Triangles.Add(lod.count / 3);
+		}
+	}
+}
+
+} // namespace scene
+} // namespace demo
@@ -0,0 +1,38 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+#include "gl.hpp"
+#include "mesh_lod.hpp"
+
+#include <array>
+
+namespace demo {
+namespace scene {
+
+// A field of procedural wave patches. Each patch picks its own level of detail
+// from the projected screen-space error.
+class Waves {
+public:
+	// Number of patches along each side of the field.
+	static constexpr int FieldSize = 8;
+
+	Waves() : mArray{0}, mBuffer{0}, mChain{}, mLevel{} {}
+	Waves(const Waves &) = delete;
+	Waves &operator=(const Waves &) = delete;
+
+	void Init();
+	// Render the scene. The height is the viewport height in pixels, which
+	// sets the screen-space error for each level of detail.
+	void Render(double time, int height);
+
+private:
+	GLuint mArray;
+	GLuint mBuffer[2];
+	mesh::LODChain mChain;
+	// Current level of detail for each patch.
+	std::array<int, FieldSize * FieldSize> mLevel;
+};
+
+} // namespace scene
+} // namespace demo
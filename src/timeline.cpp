@@ -0,0 +1,145 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#include "timeline.hpp"
+
+#include "log.hpp"
+
+#include <string>
+#include <vector>
+
+namespace demo {
+namespace timeline {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Phase {
+	std::string_view name;
+	std::string detail;
+	int depth; // Nesting depth, 0 for top-level phases.
+	Clock::time_point start;
+	Clock::time_point end;
+	int syncCount;
+	Clock::duration syncTime;
+};
+
+// Sync points with the same call in the same phase are combined.
+struct Sync {
+	int phase; // Index into Phases, or -1 if outside any phase.
+	std::string_view call;
+	int count;
+	Clock::duration time;
+};
+
+// True until Finish is called.
+bool Active = true;
+
+// Time when the program started, approximately.
+const Clock::time_point StartTime = Clock::now();
+
+std::vector<Phase> Phases;
+std::vector<int> OpenPhases; // Indexes into Phases.
+std::vector<Sync> Syncs;
+
+double Milliseconds(Clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+void BeginPhase(std::string_view name, std::string_view detail) {
+	if (!Active) {
+		return;
+	}
+	OpenPhases.push_back(static_cast<int>(Phases.size()));
+	Phases.push_back(Phase{name, std::string{detail},
+	                       static_cast<int>(OpenPhases.size()) - 1,
+	                       Clock::now(), {}, 0, {}});
+}
+
+void EndPhase() {
+	if (!Active || OpenPhases.empty()) {
+		return;
+	}
+	Phases[OpenPhases.back()].end = Clock::now();
+	OpenPhases.pop_back();
+}
+
+SyncPoint::SyncPoint(std::string_view call) : mCall{call}, mStart{} {
+	if (Active) {
+		mStart = Clock::now();
+	}
+}
+
+SyncPoint::~SyncPoint() {
+	if (!Active) {
+		return;
+	}
+	const Clock::duration time = Clock::now() - mStart;
+	const int phase = OpenPhases.empty() ? -1 : OpenPhases.back();
+	if (phase >= 0) {
+		Phases[phase].syncCount++;
+		Phases[phase].syncTime += time;
+	}
+	for (auto sync = Syncs.rbegin(); sync != Syncs.rend(); ++sync) {
+		if (sync->phase != phase) {
+			break;
+		}
+		if (sync->call == mCall) {
+			sync->count++;
+			sync->time += time;
+			return;
+		}
+	}
+	Syncs.push_back(Sync{phase, mCall, 1, time});
+}
+
+void Finish() {
+	if (!Active) {
+		return;
+	}
+	const Clock::time_point now = Clock::now();
+	while (!OpenPhases.empty()) {
+		EndPhase();
+	}
+	Active = false;
+
+	for (const Phase &phase : Phases) {
+		log::Record record{log::Level::Debug, LOG_LOCATION, "Startup phase.",
+		                   log::Attr{"phase", phase.name}};
+		if (!phase.detail.empty()) {
+			record.Add("detail", phase.detail);
+		}
+		record.Add("depth", phase.depth);
+		record.Add("start_ms", Milliseconds(phase.start - StartTime));
+		record.Add("duration_ms", Milliseconds(phase.end - phase.start));
+		if (phase.syncCount != 0) {
+			record.Add("sync_count", phase.syncCount);
+			record.Add("sync_ms", Milliseconds(phase.syncTime));
+		}
+		// One record per phase, but only once per run.
+		record.SetUnlimited();
+		record.Log();
+	}
+	for (const Sync &sync : Syncs) {
+		log::Record record{
+			log::Level::Debug, LOG_LOCATION, "GPU sync point during startup.",
+			log::Attr{"phase", sync.phase >= 0 ? Phases[sync.phase].name
+			                                   : std::string_view{}},
+			log::Attr{"call", sync.call}, log::Attr{"count", sync.count},
+			log::Attr{"duration_ms", Milliseconds(sync.time)}};
+		record.SetUnlimited();
+		record.Log();
+	}
+	LOG(Info, "Drew first frame.",
+	    log::Attr{"time_ms", Milliseconds(now - StartTime)});
+
+	Phases = {};
+	OpenPhases = {};
+	Syncs = {};
+}
+
+} // namespace timeline
+} // namespace demo
@@ -0,0 +1,64 @@
+// Copyright 2025 Dietrich Epp <depp@zdome.net>
+// Licensed under the Mozilla Public License Version 2.0.
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+// Startup timeline. Startup is broken into timed phases, and calls which make
+// the CPU wait for the GPU are flagged. The results are logged once the first
+// frame is drawn. In the competition build, this does nothing.
+
+#include <string_view>
+
+#if !COMPO
+#include <chrono>
+#endif
+
+namespace demo {
+namespace timeline {
+
+#if COMPO
+
+inline void BeginPhase(std::string_view name, std::string_view detail = {}) {
+	(void)name;
+	(void)detail;
+}
+inline void EndPhase() {}
+inline void Finish() {}
+
+class SyncPoint {
+public:
+	explicit SyncPoint(std::string_view call) { (void)call; }
+};
+
+#else
+
+// Start a phase of startup. Phases may be nested. The name must be a string
+// constant. The detail, if any, is copied.
+void BeginPhase(std::string_view name, std::string_view detail = {});
+
+// End the most recent phase started with BeginPhase.
+void EndPhase();
+
+// End the timeline and log the results. Call after the first frame is drawn.
+// Phases and sync points after this are ignored.
+void Finish();
+
+// Marks a call which forces a sync between the CPU and GPU, such as
+// glGetProgramiv with GL_LINK_STATUS. Times the call until this object is
+// destroyed. The call name must be a string constant.
+class SyncPoint {
+public:
+	explicit SyncPoint(std::string_view call);
+	SyncPoint(const SyncPoint &) = delete;
+	SyncPoint &operator=(const SyncPoint &) = delete;
+	~SyncPoint();
+
+private:
+	std::string_view mCall;
+	std::chrono::steady_clock::time_point mStart;
+};
+
+#endif
+
+} // namespace timeline
+} // namespace demo
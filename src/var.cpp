@@ -5,6 +5,7 @@
 
 #include "log.hpp"
 
+#include <charconv>
 #include <optional>
 
 namespace demo {
@@ -51,9 +52,21 @@ std::optional<bool> ParseBool(std::string_view value) {
 	return std::nullopt;
 }
 
+std::optional<int> ParseInt(std::string_view value) {
+	int result;
+	const char *const end = value.data() + value.size();
+	const std::from_chars_result r =
+		std::from_chars(value.data(), end, result);
+	if (r.ec != std::errc{} || r.ptr != end) {
+		return std::nullopt;
+	}
+	return result;
+}
+
 // Kinds of variable data.
 enum class Kind {
 	Bool,
+	Int,
 	String,
 #if _WIN32
 	WideString,
@@ -67,6 +80,10 @@ public:
 		: mName{name}, mKind{Kind::Bool} {
 		mData.boolVar = value;
 	}
+	constexpr VarDefinition(std::string_view name, var::Var<int> *value)
+		: mName{name}, mKind{Kind::Int} {
+		mData.intVar = value;
+	}
 	constexpr VarDefinition(std::string_view name, var::Var<std::string> *value)
 		: mName{name}, mKind{Kind::String} {
 		mData.stringVar = value;
@@ -91,6 +108,14 @@ public:
 			}
 			mData.boolVar->set(*parsed);
 		} break;
+		case Kind::Int: {
+			std::optional<int> parsed = ParseInt(string);
+			if (!parsed.has_value()) {
+				FAIL("Invalid integer.", log::Attr{"var", mName},
+				     log::Attr{"value", string});
+			}
+			mData.intVar->set(*parsed);
+		} break;
 		case Kind::String:
 			mData.stringVar->set(string);
 			break;
@@ -114,6 +139,7 @@ private:
 	Kind mKind;
 	union {
 		var::Var<bool> *boolVar;
+		var::Var<int> *intVar;
 		var::Var<std::string> *stringVar;
 		var::Var<std::wstring> *wideStringVar;
 	} mData;
@@ -57,7 +57,7 @@ struct VarTraits<std::basic_string<T>> {
 template <typename T>
 class Var {
 public:
-	using Traits = typename VarTraits<T>;
+	using Traits = VarTraits<T>;
 	using Storage = typename Traits::Storage;
 	using Value = typename Traits::Value;
 
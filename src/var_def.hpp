@@ -10,3 +10,30 @@
 DEFVAR(DebugContext, bool, "If true, create a debug OpenGL context.")
 DEFVAR(AllocConsole, bool, "If true, allocate a console (Windows).")
 DEFVAR(ProjectPath, os_string, "Path to the directory containing this project.")
+DEFVAR(ShaderCache, os_string,
+       "Path to directory for caching compiled shader programs.")
+DEFVAR(LogLevel, os_string,
+       "Minimum level to log: debug, info, warn, or error.")
+DEFVAR(LogBinary, os_string,
+       "Path to write the log in binary format, for \"tools logdecode\".")
+DEFVAR(LogJSON, os_string, "Path to write the log as JSON Lines.")
+DEFVAR(LogFlight, os_string,
+       "Path to a flight recorder file, which keeps the most recent log.")
+DEFVAR(LogFlightSize, int,
+       "Size of the flight recorder, in megabytes. Defaults to 4.")
+DEFVAR(LogAsync, bool,
+       "If true, write log messages from a background thread.")
+DEFVAR(Metrics, bool, "If true, log metrics every 60 frames.")
+DEFVAR(GLProfile, bool,
+       "If true, count OpenGL calls and log the counts per frame.")
+DEFVAR(GLProfileTime, bool,
+       "If true, also measure time spent in each OpenGL call (with GLProfile).")
+DEFVAR(GLTrace, os_string,
+       "Path to an OpenGL call trace, written by the demo and read by Replay.")
+DEFVAR(GLTraceFrames, int,
+       "Number of frames to trace, with GLTrace. Defaults to 60.")
+DEFVAR(ReplayPasses, int,
+       "Number of times Replay plays back a trace. Defaults to 10.")
+DEFVAR(Scene, os_string, "Scene to show: cube or waves. Defaults to cube.")
+DEFVAR(CubeFog, bool,
+       "If true, draw the cube with depth fog, using a shader variant.")
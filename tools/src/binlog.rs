@@ -0,0 +1,436 @@
+//! Decoder for binary logs, written by the demo when LogBinary is set, and for
+//! flight recorder files, written when LogFlight is set. See
+//! src/log_binary.cpp and src/log_flight.cpp for the formats.
+
+use std::error;
+use std::fmt::{self, Write};
+
+/// First four bytes of a binary log.
+const MAGIC: &[u8; 4] = b"LDB2";
+
+/// First four bytes of a flight recorder file.
+const FLIGHT_MAGIC: &[u8; 4] = b"LDF1";
+
+/// Size of the flight recorder header.
+const FLIGHT_HEADER_SIZE: usize = 64;
+
+const TAG_SITE: u8 = 1;
+const TAG_RECORD: u8 = 2;
+
+/// Level names. These have the same width, like the text log.
+const LEVELS: [&str; 4] = ["DEBUG", "INFO ", "WARN ", "ERROR"];
+
+/// Error decoding a binary log.
+#[derive(Debug, Clone)]
+pub enum DecodeError {
+    BadMagic,
+    Truncated(usize),
+    UnknownTag(usize, u8),
+    UnknownSite(usize, u32),
+    UnknownKind(usize, u8),
+}
+
+impl fmt::Display for DecodeError {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        use DecodeError::*;
+        match self {
+            BadMagic => f.write_str("file is not a binary log"),
+            Truncated(pos) => write!(f, "log is truncated at offset {}", pos),
+            UnknownTag(pos, tag) => write!(f, "unknown tag {} at offset {}", tag, pos),
+            UnknownSite(pos, id) => write!(f, "unknown site {} at offset {}", id, pos),
+            UnknownKind(pos, kind) => {
+                write!(f, "unknown value kind {} at offset {}", kind, pos)
+            }
+        }
+    }
+}
+
+impl error::Error for DecodeError {}
+
+/// A call site, which contains the static parts of a record.
+struct Site {
+    level: u8,
+    line: u32,
+    file: String,
+    function: String,
+    message: String,
+    /// Attribute names. Records contain only the values.
+    names: Vec<String>,
+}
+
+/// Reads values from a binary log.
+struct Reader<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn bytes(&mut self, size: usize) -> Result<&'a [u8], DecodeError> {
+        if size > self.data.len() - self.pos {
+            return Err(DecodeError::Truncated(self.pos));
+        }
+        let bytes = &self.data[self.pos..self.pos + size];
+        self.pos += size;
+        Ok(bytes)
+    }
+
+    fn u8(&mut self) -> Result<u8, DecodeError> {
+        Ok(self.bytes(1)?[0])
+    }
+
+    fn u32(&mut self) -> Result<u32, DecodeError> {
+        Ok(u32::from_le_bytes(self.bytes(4)?.try_into().unwrap()))
+    }
+
+    fn u64(&mut self) -> Result<u64, DecodeError> {
+        Ok(u64::from_le_bytes(self.bytes(8)?.try_into().unwrap()))
+    }
+
+    fn string(&mut self) -> Result<&'a [u8], DecodeError> {
+        let size = self.u32()? as usize;
+        self.bytes(size)
+    }
+
+    fn wide_string(&mut self) -> Result<Vec<u16>, DecodeError> {
+        let count = self.u32()? as usize;
+        let bytes = self.bytes(count.checked_mul(2).unwrap_or(usize::MAX))?;
+        Ok(bytes
+            .chunks_exact(2)
+            .map(|b| u16::from_le_bytes([b[0], b[1]]))
+            .collect())
+    }
+}
+
+/// Return true if the string should be quoted, like DoesNeedQuotes in
+/// log_standard.cpp for inline strings.
+fn needs_quotes(units: impl Iterator<Item = u32>) -> bool {
+    let mut empty = true;
+    for ch in units {
+        empty = false;
+        if ch < 33 || 126 < ch || ch == '"' as u32 || ch == '\\' as u32 {
+            return true;
+        }
+    }
+    empty
+}
+
+/// Append an escaped ASCII character, like TextBuffer::AppendEscaped.
+fn write_escaped_ascii(out: &mut String, ch: u8) {
+    match ch {
+        b'\t' => out.push_str("\\t"),
+        b'\n' => out.push_str("\\n"),
+        b'\r' => out.push_str("\\r"),
+        b'"' => out.push_str("\\\""),
+        b'\\' => out.push_str("\\\\"),
+        32..=126 => out.push(ch as char),
+        _ => write!(out, "\\x{:02x}", ch).unwrap(),
+    }
+}
+
+fn write_escaped_char(out: &mut String, ch: char) {
+    let code = ch as u32;
+    if code < 0x80 {
+        write_escaped_ascii(out, code as u8);
+    } else if code < 0x10000 {
+        write!(out, "\\u{:04x}", code).unwrap();
+    } else {
+        write!(out, "\\U{:08x}", code).unwrap();
+    }
+}
+
+fn write_string(out: &mut String, value: &[u8]) {
+    if !needs_quotes(value.iter().map(|&b| b as u32)) {
+        // Only printable ASCII.
+        out.push_str(std::str::from_utf8(value).unwrap());
+        return;
+    }
+    out.push('"');
+    for chunk in value.utf8_chunks() {
+        for ch in chunk.valid().chars() {
+            write_escaped_char(out, ch);
+        }
+        for &b in chunk.invalid() {
+            write!(out, "\\x{:02x}", b).unwrap();
+        }
+    }
+    out.push('"');
+}
+
+fn write_wide_string(out: &mut String, value: &[u16]) {
+    if !needs_quotes(value.iter().map(|&u| u as u32)) {
+        out.extend(value.iter().map(|&u| u as u8 as char));
+        return;
+    }
+    out.push('"');
+    for ch in char::decode_utf16(value.iter().copied()) {
+        match ch {
+            Ok(ch) => write_escaped_char(out, ch),
+            Err(e) => write!(out, "\\u{:04x}", e.unpaired_surrogate()).unwrap(),
+        }
+    }
+    out.push('"');
+}
+
+/// Append a floating-point number, like std::to_chars with
+/// std::chars_format::general and no precision.
+fn write_float(out: &mut String, value: f64) {
+    if value.is_nan() {
+        out.push_str(if value.is_sign_negative() {
+            "-nan"
+        } else {
+            "nan"
+        });
+        return;
+    }
+    if value.is_infinite() {
+        out.push_str(if value < 0.0 { "-inf" } else { "inf" });
+        return;
+    }
+    // Shortest round-trip digits, as "d.ddde[-]x".
+    let sci = format!("{:e}", value);
+    let (mantissa, exponent) = sci.split_once('e').unwrap();
+    let exponent: i32 = exponent.parse().unwrap();
+    let (negative, mantissa) = match mantissa.strip_prefix('-') {
+        Some(m) => (true, m),
+        None => (false, mantissa),
+    };
+    let digits: String = mantissa.chars().filter(|&c| c != '.').collect();
+    let precision = digits.len() as i32;
+    if negative {
+        out.push('-');
+    }
+    if -4 <= exponent && exponent < precision {
+        if exponent < 0 {
+            out.push_str("0.");
+            for _ in 0..-exponent - 1 {
+                out.push('0');
+            }
+            out.push_str(&digits);
+        } else {
+            let point = exponent as usize + 1;
+            out.push_str(&digits[..point]);
+            if point < digits.len() {
+                out.push('.');
+                out.push_str(&digits[point..]);
+            }
+        }
+    } else {
+        out.push_str(mantissa);
+        let sign = if exponent < 0 { '-' } else { '+' };
+        write!(out, "e{}{:02}", sign, exponent.abs()).unwrap();
+    }
+}
+
+fn write_value(out: &mut String, r: &mut Reader) -> Result<(), DecodeError> {
+    let pos = r.pos;
+    match r.u8()? {
+        0 => out.push_str("(null)"),
+        1 => write!(out, "{}", r.u64()? as i64).unwrap(),
+        2 => write!(out, "{}", r.u64()?).unwrap(),
+        3 => write_float(out, f64::from_bits(r.u64()?)),
+        4 => out.push_str(if r.u8()? != 0 { "true" } else { "false" }),
+        5 => write_string(out, r.string()?),
+        6 => write_wide_string(out, &r.wide_string()?),
+        kind => return Err(DecodeError::UnknownKind(pos, kind)),
+    }
+    Ok(())
+}
+
+/// Read the lines in a flight recorder file, from oldest to newest. The oldest
+/// line, which may have been partially overwritten, is skipped.
+fn decode_flight(data: &[u8]) -> Result<String, DecodeError> {
+    let mut r = Reader { data, pos: 4 };
+    let header_size = r.u32()? as usize;
+    let data_size = r.u64()?;
+    let cursor = r.u64()?;
+    if header_size < FLIGHT_HEADER_SIZE
+        || data.len() < header_size
+        || ((data.len() - header_size) as u64) < data_size
+        || data_size == 0
+    {
+        return Err(DecodeError::Truncated(data.len()));
+    }
+    let ring = &data[header_size..header_size + data_size as usize];
+    let mut bytes = Vec::new();
+    if cursor <= data_size {
+        bytes.extend_from_slice(&ring[..cursor as usize]);
+    } else {
+        let pos = (cursor % data_size) as usize;
+        let old = &ring[pos..];
+        // Skip the partial line.
+        if let Some(end) = old.iter().position(|&b| b == b'\n') {
+            bytes.extend_from_slice(&old[end + 1..]);
+        }
+        bytes.extend_from_slice(&ring[..pos]);
+    }
+    Ok(String::from_utf8_lossy(&bytes).into_owned())
+}
+
+/// Decode a binary log or flight recorder file, and format each record as a line of text, like the
+/// text log without color.
+pub fn decode(data: &[u8]) -> Result<String, DecodeError> {
+    if data.starts_with(FLIGHT_MAGIC) {
+        return decode_flight(data);
+    }
+    if !data.starts_with(MAGIC) {
+        return Err(DecodeError::BadMagic);
+    }
+    let mut r = Reader { data, pos: 4 };
+    let mut sites: Vec<Option<Site>> = Vec::new();
+    let mut out = String::new();
+    while r.pos < data.len() {
+        let pos = r.pos;
+        match r.u8()? {
+            TAG_SITE => {
+                let id = r.u32()? as usize;
+                let level = r.u8()?;
+                let line = r.u32()?;
+                let file = String::from_utf8_lossy(r.string()?).into_owned();
+                let function = String::from_utf8_lossy(r.string()?).into_owned();
+                let message = String::from_utf8_lossy(r.string()?).into_owned();
+                let count = r.u8()?;
+                let mut names = Vec::with_capacity(count as usize);
+                for _ in 0..count {
+                    names.push(String::from_utf8_lossy(r.string()?).into_owned());
+                }
+                let site = Site {
+                    level,
+                    line,
+                    file,
+                    function,
+                    message,
+                    names,
+                };
+                if sites.len() <= id {
+                    sites.resize_with(id + 1, || None);
+                }
+                sites[id] = Some(site);
+            }
+            TAG_RECORD => {
+                let id = r.u32()?;
+                let Some(Some(site)) = sites.get(id as usize) else {
+                    return Err(DecodeError::UnknownSite(pos, id));
+                };
+                out.push_str(LEVELS.get(site.level as usize).unwrap_or(&"?????"));
+                out.push(' ');
+                if !site.file.is_empty() {
+                    write!(
+                        out,
+                        "{}:{} ({}): ",
+                        site.file.replace('\\', "/"),
+                        site.line,
+                        site.function
+                    )
+                    .unwrap();
+                }
+                out.push_str(&site.message);
+                for name in site.names.iter() {
+                    out.push(' ');
+                    out.push_str(name);
+                    out.push('=');
+                    write_value(&mut out, &mut r)?;
+                }
+                out.push('\n');
+            }
+            tag => return Err(DecodeError::UnknownTag(pos, tag)),
+        }
+    }
+    Ok(out)
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    fn float(value: f64) -> String {
+        let mut out = String::new();
+        write_float(&mut out, value);
+        out
+    }
+
+    #[test]
+    fn test_float() {
+        assert_eq!(float(1.5), "1.5");
+        assert_eq!(float(0.0), "0");
+        assert_eq!(float(100.0), "1e+02");
+        assert_eq!(float(123.0), "123");
+        assert_eq!(float(-0.25), "-0.25");
+        assert_eq!(float(0.0001), "0.0001");
+        assert_eq!(float(0.00001), "1e-05");
+        assert_eq!(float(1.25e20), "1.25e+20");
+        assert_eq!(float(f64::INFINITY), "inf");
+    }
+
+    fn string(value: &[u8]) -> String {
+        let mut out = String::new();
+        write_string(&mut out, value);
+        out
+    }
+
+    #[test]
+    fn test_string() {
+        assert_eq!(string(b"abc"), "abc");
+        assert_eq!(string(b""), "\"\"");
+        assert_eq!(string(b"a b"), "\"a b\"");
+        assert_eq!(string(b"\"\\\n\x01"), "\"\\\"\\\\\\n\\x01\"");
+        assert_eq!(string("é😀".as_bytes()), "\"\\u00e9\\U0001f600\"");
+        assert_eq!(string(b"\xff"), "\"\\xff\"");
+    }
+
+    fn flight(data_size: u64, cursor: u64, ring: &[u8]) -> Vec<u8> {
+        let mut data = Vec::new();
+        data.extend_from_slice(FLIGHT_MAGIC);
+        data.extend_from_slice(&(FLIGHT_HEADER_SIZE as u32).to_le_bytes());
+        data.extend_from_slice(&data_size.to_le_bytes());
+        data.extend_from_slice(&cursor.to_le_bytes());
+        data.resize(FLIGHT_HEADER_SIZE, 0);
+        data.extend_from_slice(ring);
+        data
+    }
+
+    #[test]
+    fn test_flight() {
+        assert_eq!(decode(&flight(8, 4, b"a\nb\n\0\0\0\0")).unwrap(), "a\nb\n");
+        // Wrapped, after writing "aaa\nbb\nc\nd\n".
+        assert_eq!(
+            decode(&flight(8, 11, b"\nd\n\nbb\nc")).unwrap(),
+            "bb\nc\nd\n"
+        );
+    }
+
+    #[test]
+    fn test_decode() {
+        let mut data = Vec::new();
+        data.extend_from_slice(MAGIC);
+        data.push(TAG_SITE);
+        data.extend_from_slice(&0u32.to_le_bytes());
+        data.push(1);
+        data.extend_from_slice(&12u32.to_le_bytes());
+        for s in ["src/main.cpp", "Main", "Hello."] {
+            data.extend_from_slice(&(s.len() as u32).to_le_bytes());
+            data.extend_from_slice(s.as_bytes());
+        }
+        data.push(2);
+        for s in ["x", "ok"] {
+            data.extend_from_slice(&(s.len() as u32).to_le_bytes());
+            data.extend_from_slice(s.as_bytes());
+        }
+        for i in [-1i64, 2] {
+            data.push(TAG_RECORD);
+            data.extend_from_slice(&0u32.to_le_bytes());
+            data.push(1);
+            data.extend_from_slice(&i.to_le_bytes());
+            data.push(4);
+            data.push((i > 0) as u8);
+        }
+        assert_eq!(
+            decode(&data).unwrap(),
+            "INFO  src/main.cpp:12 (Main): Hello. x=-1 ok=false\n\
+             INFO  src/main.cpp:12 (Main): Hello. x=2 ok=true\n"
+        );
+        assert!(matches!(
+            decode(&data[..data.len() - 1]),
+            Err(DecodeError::Truncated(_))
+        ));
+    }
+}
@@ -9,6 +9,14 @@ use std::path::PathBuf;
 /// Generate OpenGL API bindings.
 #[derive(Parser, Debug)]
 pub struct Args {
+    /// API version and extensions to generate, like "3.3 GL_KHR_debug".
+    #[arg(long, default_value = "3.3")]
+    api: api::APISpec,
+
+    /// API version and extensions to link directly, without loading.
+    #[arg(long, default_value = "1.1")]
+    link: api::APISpec,
+
     /// File with list of OpenGL functions, one per line.
     #[arg(long)]
     entry_points: Option<PathBuf>,
@@ -20,28 +28,44 @@ pub struct Args {
     /// Output C++ source file.
     #[arg(long)]
     output_data: Option<PathBuf>,
+
+    /// Resolve function pointers on first call, instead of at startup.
+    #[arg(long)]
+    lazy: bool,
+
+    /// Generate wrappers for counting and timing calls.
+    #[arg(long)]
+    profile: bool,
+
+    /// Generate wrappers for recording traces, and functions for replaying
+    /// them.
+    #[arg(long)]
+    trace: bool,
+
+    /// Identify functions by name hashes instead of names.
+    #[arg(long)]
+    name_hashes: bool,
 }
 
 impl Args {
     pub fn run(&self) -> Result<(), Box<dyn Error>> {
-        let api = api::APISpec {
-            version: api::Version(3, 3),
-            extensions: vec![],
-        };
-        let link = api::APISpec {
-            version: api::Version(1, 1),
-            extensions: vec![],
+        let api = api::API::create(&self.api, &self.link)?;
+        let options = api::Options {
+            lazy: self.lazy,
+            profile: self.profile,
+            trace: self.trace,
+            name_hashes: self.name_hashes,
         };
-        let api = api::API::create(&api, &link)?;
+        options.validate()?;
         let bindings = match &self.entry_points {
-            None => api.make_bindings(),
+            None => api.make_bindings(&options),
             Some(path) => {
                 let text = fs::read_to_string(path)?;
                 let mut entry_points = HashSet::new();
                 for line in text.lines() {
                     entry_points.insert(line.to_string());
                 }
-                api.make_subset_bindings(&entry_points)?
+                api.make_subset_bindings(&entry_points, &options)?
             }
         };
         emit::write_or_stdout(self.output_header.as_deref(), bindings.header.as_bytes())?;
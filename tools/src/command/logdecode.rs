@@ -0,0 +1,33 @@
+use crate::binlog;
+use crate::emit;
+use crate::error::FileError;
+use clap::Parser;
+use std::error::Error;
+use std::fs;
+use std::path::PathBuf;
+
+/// Convert a binary log or flight recorder file to text.
+#[derive(Parser, Debug)]
+pub struct Args {
+    /// File to decode, written by the demo when LogBinary or LogFlight is set.
+    input: PathBuf,
+
+    /// Output file.
+    #[arg(long)]
+    output: Option<PathBuf>,
+}
+
+impl Args {
+    pub fn run(&self) -> Result<(), Box<dyn Error>> {
+        let data = fs::read(&self.input).map_err(|e| FileError {
+            path: self.input.clone(),
+            error: Box::new(e),
+        })?;
+        let text = binlog::decode(&data).map_err(|e| FileError {
+            path: self.input.clone(),
+            error: Box::new(e),
+        })?;
+        emit::write_or_stdout(self.output.as_deref(), text.as_bytes())?;
+        Ok(())
+    }
+}
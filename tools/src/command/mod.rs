@@ -4,6 +4,7 @@ pub mod buildinfo;
 pub mod glemit;
 pub mod glscan;
 pub mod listsources;
+pub mod logdecode;
 pub mod shader;
 #[cfg(target_os = "windows")]
 pub mod vsenv;
@@ -19,6 +20,7 @@ pub enum Command {
     GLEmit(glemit::Args),
     VSGen(vsgen::Args),
     ListSources(listsources::Args),
+    LogDecode(logdecode::Args),
     BuildInfo(buildinfo::Args),
 
     #[cfg(target_os = "windows")]
@@ -36,6 +38,7 @@ impl Command {
             GLEmit(c) => c.run(),
             VSGen(c) => c.run(),
             ListSources(c) => c.run(),
+            LogDecode(c) => c.run(),
             BuildInfo(c) => c.run(),
 
             #[cfg(target_os = "windows")]
@@ -16,6 +16,15 @@ pub struct Args {
     /// Output C++ file for shader data.
     output: Option<PathBuf>,
 
+    /// Output C++ header with program IDs, uniform IDs, and attribute
+    /// locations.
+    #[arg(long)]
+    output_header: Option<PathBuf>,
+
+    /// Minify shader source code.
+    #[arg(long)]
+    minify: bool,
+
     /// Dump internal information about parsed shaders.
     #[arg(long)]
     dump: bool,
@@ -37,12 +46,18 @@ impl Args {
 
         // Read the shader source code.
         let directory = self.spec.parent().expect("Must have parent directory.");
-        let data = shader::Data::read_raw(&manifest, directory)?;
+        let mut data = shader::Data::read_raw(&manifest, directory)?;
+        if self.minify {
+            data.minify()?;
+        }
 
         // Emit the output.
         let output = data.emit_text()?;
-
         emit::write_or_stdout(self.output.as_deref(), output.as_bytes())?;
+        if let Some(path) = self.output_header.as_deref() {
+            let header = data.emit_header();
+            emit::write_or_stdout(Some(path), header.as_bytes())?;
+        }
         Ok(())
     }
 }
@@ -15,6 +15,9 @@ pub const HEADER: &str = "// This file is automatically generated.
 pub struct StringWriter<'a> {
     out: &'a mut String,
     limit: usize,
+    // True if the last character written was a hex escape. A hex digit after
+    // it would be parsed as part of the escape.
+    hex_escape: bool,
 }
 
 impl<'a> StringWriter<'a> {
@@ -22,7 +25,11 @@ impl<'a> StringWriter<'a> {
     pub fn new(out: &'a mut String) -> Self {
         out.push('"');
         let limit = out.len() + (COLUMNS - 2);
-        StringWriter { out, limit }
+        StringWriter {
+            out,
+            limit,
+            hex_escape: false,
+        }
     }
 
     /// Write the end of a string (the final quote).
@@ -36,7 +43,11 @@ impl<'a> StringWriter<'a> {
         for &c in text.iter() {
             let start = self.out.len();
             if 32 <= c && c <= 126 {
-                if c == b'\\' && c == b'"' {
+                if self.hex_escape && c.is_ascii_hexdigit() {
+                    self.out.push_str("\"\"");
+                }
+                self.hex_escape = false;
+                if c == b'\\' || c == b'"' {
                     self.out.push('\\');
                 }
                 self.out.push(char::from(c));
@@ -48,6 +59,7 @@ impl<'a> StringWriter<'a> {
                     b'\n' => Some('n'),
                     _ => None,
                 };
+                self.hex_escape = escape.is_none();
                 match escape {
                     None => write!(self.out, "x{:02x}", c).unwrap(),
                     Some(ch) => self.out.push(ch),
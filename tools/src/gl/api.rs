@@ -1,3 +1,5 @@
+use super::hash::{self, PerfectHash};
+use super::trace::{self, Arg};
 use crate::emit;
 use crate::xmlparse::{
     self, element_children_tag, element_children_unchecked, node_pos, require_attribute,
@@ -390,6 +392,15 @@ struct Function {
     return_type: String,
     parameter_declarations: String,
     parameter_names: String,
+    parameters: Vec<Parameter>,
+}
+
+/// A function parameter.
+#[derive(Debug, Clone)]
+struct Parameter {
+    /// C++ type, like "const void *".
+    ty: String,
+    name: String,
 }
 
 /// Get the name and prototype for a command.
@@ -442,10 +453,14 @@ fn emit_return_type<'a>(node: Node<'a, 'a>, type_map: &TypeMap) -> Result<String
 }
 
 /// Emit the parameter declarations and parameter names, given the <command>
-/// tag.
-fn emit_parameters<'a>(node: Node<'a, 'a>, type_map: &TypeMap) -> Result<(String, String), Error> {
+/// tag. Also returns the list of parameters.
+fn emit_parameters<'a>(
+    node: Node<'a, 'a>,
+    type_map: &TypeMap,
+) -> Result<(String, String, Vec<Parameter>), Error> {
     let mut declarations = String::new();
     let mut names = String::new();
+    let mut parameters = Vec::new();
     let mut has_parameter = false;
     for child in element_children_tag(node, "param") {
         if has_parameter {
@@ -454,12 +469,15 @@ fn emit_parameters<'a>(node: Node<'a, 'a>, type_map: &TypeMap) -> Result<(String
         }
         has_parameter = true;
         let mut has_name = false;
+        let mut ty = String::new();
+        let mut name = String::new();
         for item in child.children() {
             match item.node_type() {
                 NodeType::Element => match item.tag_name().name() {
                     "ptype" => {
-                        let ty = xmlparse::parse_text_contents(item)?;
-                        declarations.push_str(type_map.map(&ty));
+                        let ptype = xmlparse::parse_text_contents(item)?;
+                        declarations.push_str(type_map.map(&ptype));
+                        ty.push_str(type_map.map(&ptype));
                     }
                     "name" => {
                         if has_name {
@@ -468,13 +486,15 @@ fn emit_parameters<'a>(node: Node<'a, 'a>, type_map: &TypeMap) -> Result<(String
                         has_name = true;
                         let pos = declarations.len();
                         xmlparse::append_text_contents(&mut declarations, item)?;
-                        names.push_str(&declarations[pos..]);
+                        name.push_str(&declarations[pos..]);
+                        names.push_str(&name);
                     }
                     _ => return Err(xmlparse::unexpected_tag(item).into()),
                 },
                 NodeType::Text => {
                     if let Some(text) = item.text() {
                         declarations.push_str(text);
+                        ty.push_str(text);
                     }
                 }
                 _ => (),
@@ -483,8 +503,12 @@ fn emit_parameters<'a>(node: Node<'a, 'a>, type_map: &TypeMap) -> Result<(String
         if !has_name {
             return Err(Error::InvalidPrototype(node_pos(child)));
         }
+        parameters.push(Parameter {
+            ty: ty.trim().to_string(),
+            name,
+        });
     }
-    Ok((declarations, names))
+    Ok((declarations, names, parameters))
 }
 
 impl Function {
@@ -500,13 +524,15 @@ impl Function {
             return Ok(None);
         };
         let return_type = emit_return_type(proto, type_map)?;
-        let (parameter_declarations, parameter_names) = emit_parameters(node, type_map)?;
+        let (parameter_declarations, parameter_names, parameters) =
+            emit_parameters(node, type_map)?;
         Ok(Some(Function {
             name: name.into(),
             call,
             return_type,
             parameter_declarations,
             parameter_names,
+            parameters,
         }))
     }
 
@@ -550,6 +576,186 @@ impl Function {
         .unwrap();
     }
 
+    /// Emit a wrapper with the same signature as this function, named with
+    /// the given prefix. The wrapper runs the prologue statements, and then
+    /// calls the function pointer given by the expression.
+    fn emit_wrapper(&self, out: &mut String, prefix: &str, prologue: &str, pointer: &str) {
+        write!(
+            out,
+            "{} GLAPI {}{}({}) {{\n\
+            \tusing Proc = {} (GLAPI *)({});\n\
+            {}\t",
+            self.return_type,
+            prefix,
+            self.name,
+            self.parameter_declarations,
+            self.return_type,
+            self.parameter_declarations,
+            prologue
+        )
+        .unwrap();
+        if self.return_type != "void" {
+            out.push_str("return ");
+        }
+        write!(
+            out,
+            "reinterpret_cast<Proc>({})({});\n}}\n",
+            pointer, self.parameter_names
+        )
+        .unwrap();
+    }
+
+    /// Emit a trampoline for this function, which resolves the function
+    /// pointer on the first call and then calls through it. The resolved
+    /// pointer replaces the trampoline in FunctionPointers, so later calls go
+    /// directly to the driver.
+    fn emit_trampoline(&self, out: &mut String, index: usize) {
+        self.emit_wrapper(out, "Lazy_", "", &format!("ResolveProc({})", index));
+    }
+
+    /// Emit a profiling wrapper for this function, which counts and times
+    /// calls before calling the real function.
+    fn emit_profile(&self, out: &mut String, index: usize) {
+        self.emit_wrapper(
+            out,
+            "Profile_",
+            &format!("\tconst gl_profile::Scope scope{{{}}};\n", index),
+            &format!("RealFunctionPointers[{}]", index),
+        );
+    }
+
+    /// Emit a tracing wrapper for this function, which calls the real
+    /// function and then records the call. Also emits a replay function,
+    /// which reads the call from a trace and makes it again. Returns false if
+    /// the function cannot be traced, in which case the wrapper only reports
+    /// that and there is no replay function.
+    fn emit_trace(&self, out: &mut Trace, index: usize) -> bool {
+        let parameters: Vec<(&str, &str)> = self
+            .parameters
+            .iter()
+            .map(|p| (p.ty.as_str(), p.name.as_str()))
+            .collect();
+        let pointer = format!("RealFunctionPointers[{}]", index);
+        let Some(args) = trace::classify(&self.name, &self.return_type, &parameters) else {
+            self.emit_wrapper(
+                &mut out.wrappers,
+                "Trace_",
+                &format!("\tgl_trace::Unsupported({});\n", index),
+                &pointer,
+            );
+            return false;
+        };
+
+        // Wrapper.
+        let has_result = self.return_type != "void";
+        let out_wrappers = &mut out.wrappers;
+        write!(
+            out_wrappers,
+            "{} GLAPI Trace_{}({}) {{\n\
+            \tusing Proc = {} (GLAPI *)({});\n\t",
+            self.return_type,
+            self.name,
+            self.parameter_declarations,
+            self.return_type,
+            self.parameter_declarations
+        )
+        .unwrap();
+        if has_result {
+            write!(out_wrappers, "const {} result = ", self.return_type).unwrap();
+        }
+        write!(
+            out_wrappers,
+            "reinterpret_cast<Proc>({})({});\n\
+            \tgl_trace::Call call{{{}}};\n",
+            pointer, self.parameter_names, index
+        )
+        .unwrap();
+        for (arg, parameter) in args.iter().zip(self.parameters.iter()) {
+            let name = &parameter.name;
+            match arg {
+                Arg::Value => writeln!(out_wrappers, "\tcall.Value({});", name),
+                Arg::Offset => writeln!(
+                    out_wrappers,
+                    "\tcall.Value(reinterpret_cast<std::uintptr_t>({}));",
+                    name
+                ),
+                Arg::Data(size) => writeln!(
+                    out_wrappers,
+                    "\tcall.Data({}, static_cast<std::size_t>({}));",
+                    name, size
+                ),
+                Arg::String => writeln!(out_wrappers, "\tcall.String({});", name),
+                Arg::Strings(count, length) => writeln!(
+                    out_wrappers,
+                    "\tcall.Strings({}, {}, {});",
+                    count,
+                    name,
+                    length.as_deref().unwrap_or("nullptr")
+                ),
+                Arg::StringLengths | Arg::Output => Ok(()),
+            }
+            .unwrap();
+        }
+        if has_result {
+            out_wrappers.push_str("\treturn result;\n");
+        }
+        out_wrappers.push_str("}\n");
+
+        // Replay function.
+        let out_replay = &mut out.replay;
+        writeln!(
+            out_replay,
+            "void Replay_{}(gl_trace::Reader &reader) {{",
+            self.name
+        )
+        .unwrap();
+        for (arg, parameter) in args.iter().zip(self.parameters.iter()) {
+            let (ty, name) = (&parameter.ty, &parameter.name);
+            match arg {
+                Arg::Value => writeln!(
+                    out_replay,
+                    "\tconst auto {} = reader.Value<{}>();",
+                    name, ty
+                ),
+                Arg::Offset => writeln!(
+                    out_replay,
+                    "\tconst auto {} = reinterpret_cast<{}>(reader.Value<std::uintptr_t>());",
+                    name, ty
+                ),
+                Arg::Data(_) => writeln!(
+                    out_replay,
+                    "\tconst auto {} = static_cast<{}>(reader.Data());",
+                    name, ty
+                ),
+                Arg::String => writeln!(out_replay, "\tconst auto {} = reader.String();", name),
+                Arg::Strings(_, _) => {
+                    writeln!(out_replay, "\tconst auto {} = reader.Strings();", name)
+                }
+                Arg::StringLengths => {
+                    writeln!(
+                        out_replay,
+                        "\tconst auto {} = reader.StringLengths();",
+                        name
+                    )
+                }
+                Arg::Output => writeln!(
+                    out_replay,
+                    "\tconst auto {} = static_cast<{}>(reader.Scratch());",
+                    name, ty
+                ),
+            }
+            .unwrap();
+        }
+        write!(
+            out_replay,
+            "\t{}({});\n\
+            }}\n",
+            self.name, self.parameter_names
+        )
+        .unwrap();
+        true
+    }
+
     /// Emit a runtime binding to this function.
     fn emit_runtime(&self, out: &mut String, index: usize) {
         write!(
@@ -568,7 +774,7 @@ impl Function {
         }
         write!(
             out,
-            "static_cast<Proc>(demo::gl_api::FunctionPointers[{}])({});\n}}\n",
+            "reinterpret_cast<Proc>(demo::gl_api::FunctionPointers[{}])({});\n}}\n",
             index, self.parameter_names
         )
         .unwrap();
@@ -584,6 +790,9 @@ pub struct API {
     enums: String,
     functions: Vec<Function>,
     extensions: Vec<String>,
+    /// Names of every command in the registry, used to pick name hashes
+    /// which do not collide.
+    commands: Vec<String>,
 }
 
 impl API {
@@ -596,6 +805,12 @@ impl API {
         let features = FeatureSet::build(node, &spec)?;
         let enums = emit_enums(&features.enums, node, &type_map)?;
         let functions = Function::parse_all(&features.commands, node, &type_map)?;
+        let mut commands = Vec::new();
+        for child in element_children_tag(node, "commands") {
+            for item in element_children_tag(child, "command") {
+                commands.push(command_info(item)?.0);
+            }
+        }
         let mut extensions: Vec<String> = spec
             .extensions
             .keys()
@@ -606,6 +821,7 @@ impl API {
             enums,
             functions,
             extensions,
+            commands,
         })
     }
 
@@ -618,20 +834,21 @@ impl API {
     }
 
     /// Create bindings for this API.
-    pub fn make_bindings(&self) -> Bindings {
-        self.make_bindings_impl(None)
+    pub fn make_bindings(&self, options: &Options) -> Bindings {
+        self.make_bindings_impl(None, options)
     }
 
     /// Create bindings for a subset of this API.
     pub fn make_subset_bindings(
         &self,
         subset: &HashSet<String>,
+        options: &Options,
     ) -> Result<Bindings, UnknownFunctions> {
-        Ok(self.make_bindings_impl(Some(subset)))
+        Ok(self.make_bindings_impl(Some(subset), options))
     }
 
-    fn make_bindings_impl(&self, subset: Option<&HashSet<String>>) -> Bindings {
-        let functions = Functions::emit(self, subset);
+    fn make_bindings_impl(&self, subset: Option<&HashSet<String>>, options: &Options) -> Bindings {
+        let functions = Functions::emit(self, subset, options);
         Bindings {
             header: emit_header(&self.enums, &functions, &self.extensions),
             data: emit_data(&functions, &self.extensions),
@@ -639,6 +856,36 @@ impl API {
     }
 }
 
+/// Options for generating bindings.
+#[derive(Debug, Clone, Default)]
+pub struct Options {
+    /// Resolve function pointers on first call, instead of all at startup.
+    pub lazy: bool,
+    /// Generate profiling wrappers for every function. All functions are
+    /// called through pointers, even ones that could be linked, so the
+    /// wrappers can be installed at runtime.
+    pub profile: bool,
+    /// Generate wrappers for recording traces, and functions for replaying
+    /// them. Like profile, all functions are called through pointers.
+    pub trace: bool,
+    /// Identify the linkable functions by 32-bit name hashes instead of
+    /// names, for loaders which match them against the library's export
+    /// table. All functions are called through pointers, and the remaining
+    /// functions are still loaded by name. Lazy loading, profiling, and
+    /// tracing need every name, so this cannot be combined with them.
+    pub name_hashes: bool,
+}
+
+impl Options {
+    /// Check that the options can be used together.
+    pub fn validate(&self) -> Result<(), &'static str> {
+        if self.name_hashes && (self.lazy || self.profile || self.trace) {
+            return Err("name hashes cannot be combined with lazy, profile, or trace");
+        }
+        Ok(())
+    }
+}
+
 /// Indicates that some requested functions do not exist in this API.
 #[derive(Debug)]
 pub struct UnknownFunctions(Vec<String>);
@@ -673,14 +920,63 @@ impl error::Error for UnknownFunctions {}
 struct Functions {
     functions: String,
     lookups: Vec<ArcStr>,
+    /// Number of functions at the start of lookups which are identified by
+    /// name hash. The rest are identified by name.
+    hashed: usize,
+    /// Trampolines for lazy loading, or None if functions are loaded eagerly.
+    trampolines: Option<String>,
+    /// Profiling wrappers, or None if profiling is not supported.
+    profile: Option<String>,
+    /// Tracing wrappers and replay functions, or None if tracing is not
+    /// supported.
+    trace: Option<Trace>,
+    /// Perfect hash table for function names, or None if functions are
+    /// identified by name.
+    name_hash: Option<PerfectHash>,
+}
+
+/// Generated code for recording and replaying traces.
+#[derive(Default)]
+struct Trace {
+    wrappers: String,
+    replay: String,
+    /// Whether each function in the lookup table has a replay function.
+    replayable: Vec<bool>,
 }
 
 impl Functions {
-    fn emit(api: &API, subset: Option<&HashSet<String>>) -> Self {
+    fn emit(api: &API, subset: Option<&HashSet<String>>, options: &Options) -> Self {
         let mut functions = String::new();
         let mut lookups: Vec<ArcStr> = Vec::new();
-        for function in api.functions.iter() {
-            match function.call {
+        let mut trampolines = if options.lazy {
+            Some(String::new())
+        } else {
+            None
+        };
+        let mut profile = if options.profile {
+            Some(String::new())
+        } else {
+            None
+        };
+        let mut trace = if options.trace {
+            Some(Trace::default())
+        } else {
+            None
+        };
+        let mut ordered: Vec<&Function> = api.functions.iter().collect();
+        if options.name_hashes {
+            // Linkable functions first, so they can be matched against the
+            // library's exports.
+            ordered.sort_by_key(|function| function.call != CallType::Linker);
+        }
+        let mut hashed = 0;
+        for &function in ordered.iter() {
+            let call = if options.profile || options.trace || options.name_hashes {
+                CallType::Runtime
+            } else {
+                function.call
+            };
+            match call {
                 CallType::Linker => function.emit_linked(&mut functions),
                 CallType::Runtime => {
                     let include = match subset {
@@ -690,14 +986,42 @@ impl Functions {
                     if include {
                         let index = lookups.len();
                         lookups.push(function.name.clone());
+                        if options.name_hashes && function.call == CallType::Linker {
+                            hashed += 1;
+                        }
                         function.emit_runtime(&mut functions, index);
+                        if let Some(out) = trampolines.as_mut() {
+                            function.emit_trampoline(out, index);
+                        }
+                        if let Some(out) = profile.as_mut() {
+                            function.emit_profile(out, index);
+                        }
+                        if let Some(out) = trace.as_mut() {
+                            let replayable = function.emit_trace(out, index);
+                            out.replayable.push(replayable);
+                        }
                     } else {
                         function.emit_missing(&mut functions);
                     }
                 }
             }
         }
-        Functions { functions, lookups }
+        let name_hash = if options.name_hashes {
+            let keys: Vec<&str> = lookups[..hashed].iter().map(|name| name.as_str()).collect();
+            let avoid: Vec<&str> = api.commands.iter().map(String::as_str).collect();
+            Some(PerfectHash::build_avoiding(&keys, &avoid))
+        } else {
+            None
+        };
+        Functions {
+            functions,
+            lookups,
+            hashed,
+            trampolines,
+            profile,
+            trace,
+            name_hash,
+        }
     }
 }
 
@@ -720,18 +1044,58 @@ fn emit_header(enums: &str, functions: &Functions, extensions: &[String]) -> Str
         functions.lookups.len()
     )
     .unwrap();
-    write!(
-        out,
+    out.push_str(
         "extern void *FunctionPointers[FunctionPointerCount];\n\
-        extern const char FunctionNames[];\n\
-        constexpr int ExtensionCount = {};\n",
-        extensions.len()
-    )
-    .unwrap();
+        extern const char FunctionNames[];\n",
+    );
+    if let Some(hash) = &functions.name_hash {
+        // See LoadProcs in gl_linux.cpp and main_windows_compo.cpp. Functions
+        // before FunctionHashCount are identified by hash, and FunctionNames
+        // contains the names of the rest.
+        write!(
+            out,
+            "#define GL_NAME_HASHES 1\n\
+            constexpr int FunctionHashCount = {};\n\
+            constexpr unsigned FunctionHashSeed = 0x{:08x};\n\
+            constexpr int FunctionHashBits = {};\n\
+            constexpr int FunctionBucketBits = {};\n\
+            extern const unsigned FunctionHashes[FunctionHashCount];\n\
+            extern const unsigned FunctionDisplacements[1 << FunctionBucketBits];\n\
+            extern const unsigned short FunctionHashTable[1 << FunctionHashBits];\n",
+            functions.hashed, hash.seed, hash.bits, hash.bucket_bits
+        )
+        .unwrap();
+    }
+    writeln!(out, "constexpr int ExtensionCount = {};", extensions.len()).unwrap();
+    if functions.trampolines.is_some() {
+        out.push_str(
+            "#define GL_LAZY_PROCS 1\n\
+            extern const unsigned short FunctionNameOffsets[FunctionPointerCount];\n",
+        );
+    }
+    if functions.profile.is_some() || functions.trace.is_some() {
+        out.push_str(
+            "#define GL_INTERPOSE 1\n\
+            extern void *RealFunctionPointers[FunctionPointerCount];\n",
+        );
+    }
+    if functions.profile.is_some() {
+        out.push_str(
+            "#define GL_PROFILE 1\n\
+            extern void *const ProfileFunctionPointers[FunctionPointerCount];\n",
+        );
+    }
+    if functions.trace.is_some() {
+        out.push_str(
+            "#define GL_TRACE 1\n\
+            extern void *const TraceFunctionPointers[FunctionPointerCount];\n",
+        );
+    }
     if !extensions.is_empty() {
         out.push_str(
             "extern bool ExtensionAvailable[ExtensionCount];\n\
             extern const char ExtensionNames[];\n\
+            extern const unsigned short ExtensionNameOffsets[ExtensionCount];\n\
             class Extension {\n\
             public:\n\
             \texplicit constexpr Extension(int index): mIndex{index} {}\n\
@@ -740,6 +1104,22 @@ fn emit_header(enums: &str, functions: &Functions, extensions: &[String]) -> Str
             \tint mIndex;\n\
             };\n",
         );
+        // Perfect hash table for looking up extension names. See
+        // FindExtension in gl_common.cpp.
+        let hash = extension_hash(extensions);
+        write!(
+            out,
+            "constexpr unsigned ExtensionHashSeed = 0x{:08x};\n\
+            constexpr int ExtensionHashBits = {};\n\
+            constexpr int ExtensionBucketBits = {};\n\
+            extern const unsigned ExtensionDisplacements[1 << ExtensionBucketBits];\n\
+            extern const {} ExtensionHashTable[1 << ExtensionHashBits];\n",
+            hash.seed,
+            hash.bits,
+            hash.bucket_bits,
+            hash_table_type(extensions)
+        )
+        .unwrap();
         for (n, name) in extensions.iter().enumerate() {
             assert!(name.starts_with("GL_"));
             let short_name = &name[3..];
@@ -775,6 +1155,16 @@ fn emit_header(enums: &str, functions: &Functions, extensions: &[String]) -> Str
 fn emit_data(functions: &Functions, extensions: &[String]) -> String {
     let mut out = String::new();
     out.push_str(emit::HEADER);
+    if functions.trampolines.is_some() || functions.profile.is_some() || functions.trace.is_some() {
+        // The wrappers need the OpenGL types and the functions they call.
+        out.push_str("#include \"gl.hpp\"\n");
+    }
+    if functions.profile.is_some() {
+        out.push_str("#include \"gl_profile.hpp\"\n");
+    }
+    if functions.trace.is_some() {
+        out.push_str("#include \"gl_trace.hpp\"\n");
+    }
 
     out.push_str(
         "namespace demo {\n\
@@ -786,16 +1176,104 @@ fn emit_data(functions: &Functions, extensions: &[String]) -> String {
         .map(|name| name.len())
         .sum::<usize>()
         + functions.lookups.len();
-    write!(
+    match &functions.trampolines {
+        None => writeln!(out, "void *FunctionPointers[{}];", functions.lookups.len()).unwrap(),
+        Some(trampolines) => {
+            // Each pointer starts out pointing at its trampoline.
+            out.push_str("namespace {\n");
+            out.push_str(trampolines);
+            write!(
+                out,
+                "}}\n\
+                void *FunctionPointers[{}] = {{\n",
+                functions.lookups.len()
+            )
+            .unwrap();
+            for name in functions.lookups.iter() {
+                writeln!(out, "reinterpret_cast<void *>(Lazy_{}),", name).unwrap();
+            }
+            out.push_str("};\n");
+            assert!(size <= 0x10000, "function names too long for offset table");
+            write!(
+                out,
+                "extern const unsigned short FunctionNameOffsets[{}] = {{",
+                functions.lookups.len()
+            )
+            .unwrap();
+            let mut offset = 0;
+            for (n, name) in functions.lookups.iter().enumerate() {
+                if n != 0 {
+                    out.push_str(", ");
+                }
+                write!(out, "{}", offset).unwrap();
+                offset += name.len() + 1;
+            }
+            out.push_str("};\n");
+        }
+    }
+    if functions.profile.is_some() || functions.trace.is_some() {
+        writeln!(
+            out,
+            "void *RealFunctionPointers[{}];",
+            functions.lookups.len()
+        )
+        .unwrap();
+    }
+    if let Some(profile) = &functions.profile {
+        out.push_str("namespace {\n");
+        out.push_str(profile);
+        write!(
+            out,
+            "}}\n\
+            void *const ProfileFunctionPointers[{}] = {{\n",
+            functions.lookups.len()
+        )
+        .unwrap();
+        for name in functions.lookups.iter() {
+            writeln!(out, "reinterpret_cast<void *>(Profile_{}),", name).unwrap();
+        }
+        out.push_str("};\n");
+    }
+    if let Some(trace) = &functions.trace {
+        out.push_str("namespace {\n");
+        out.push_str(&trace.wrappers);
+        out.push_str(&trace.replay);
+        write!(
+            out,
+            "}}\n\
+            void *const TraceFunctionPointers[{}] = {{\n",
+            functions.lookups.len()
+        )
+        .unwrap();
+        for name in functions.lookups.iter() {
+            writeln!(out, "reinterpret_cast<void *>(Trace_{}),", name).unwrap();
+        }
+        write!(
+            out,
+            "}};\n\
+            const gl_trace::ReplayFunction ReplayFunctions[{}] = {{\n",
+            functions.lookups.len()
+        )
+        .unwrap();
+        for (name, &replayable) in functions.lookups.iter().zip(trace.replayable.iter()) {
+            if replayable {
+                writeln!(out, "Replay_{},", name).unwrap();
+            } else {
+                out.push_str("nullptr,\n");
+            }
+        }
+        out.push_str("};\n");
+    }
+    let named = &functions.lookups[functions.hashed..];
+    let names_size = named.iter().map(|name| name.len()).sum::<usize>() + named.len();
+    writeln!(
         out,
-        "void *FunctionPointers[{}];\n\
-        extern const char FunctionNames[{}] =\n",
-        functions.lookups.len(),
-        size
+        "extern const char FunctionNames[{}] =",
+        names_size.max(1)
     )
     .unwrap();
     let mut writer = emit::StringWriter::new(&mut out);
-    for (n, name) in functions.lookups.iter().enumerate() {
+    for (n, name) in named.iter().enumerate() {
         if n != 0 {
             writer.write(&[0]);
         }
@@ -803,6 +1281,47 @@ fn emit_data(functions: &Functions, extensions: &[String]) -> String {
     }
     writer.finish();
     out.push_str(";\n");
+    if let Some(hash) = &functions.name_hash {
+        write!(
+            out,
+            "extern const unsigned FunctionHashes[{}] = {{",
+            functions.hashed
+        )
+        .unwrap();
+        for (n, name) in functions.lookups[..functions.hashed].iter().enumerate() {
+            if n != 0 {
+                out.push_str(", ");
+            }
+            write!(out, "0x{:08x}", hash::hash(hash.seed, name.as_bytes())).unwrap();
+        }
+        out.push_str("};\n");
+        write!(
+            out,
+            "extern const unsigned FunctionDisplacements[{}] = {{",
+            hash.displacements.len()
+        )
+        .unwrap();
+        for (n, displacement) in hash.displacements.iter().enumerate() {
+            if n != 0 {
+                out.push_str(", ");
+            }
+            write!(out, "{}", displacement).unwrap();
+        }
+        out.push_str("};\n");
+        write!(
+            out,
+            "extern const unsigned short FunctionHashTable[{}] = {{",
+            hash.table.len()
+        )
+        .unwrap();
+        for (n, index) in hash.table.iter().enumerate() {
+            if n != 0 {
+                out.push_str(", ");
+            }
+            write!(out, "{}", index).unwrap();
+        }
+        out.push_str("};\n");
+    }
     if !extensions.is_empty() {
         let size = extensions.iter().map(|name| name.len()).sum::<usize>() + extensions.len();
         write!(
@@ -822,11 +1341,70 @@ fn emit_data(functions: &Functions, extensions: &[String]) -> String {
         }
         writer.finish();
         out.push_str(";\n");
+        write!(
+            out,
+            "extern const unsigned short ExtensionNameOffsets[{}] = {{",
+            extensions.len()
+        )
+        .unwrap();
+        let mut offset = 0;
+        for (n, name) in extensions.iter().enumerate() {
+            if n != 0 {
+                out.push_str(", ");
+            }
+            write!(out, "{}", offset).unwrap();
+            offset += name.len() + 1;
+        }
+        out.push_str("};\n");
+        let hash = extension_hash(extensions);
+        write!(
+            out,
+            "extern const unsigned ExtensionDisplacements[{}] = {{",
+            hash.displacements.len()
+        )
+        .unwrap();
+        for (n, displacement) in hash.displacements.iter().enumerate() {
+            if n != 0 {
+                out.push_str(", ");
+            }
+            write!(out, "{}", displacement).unwrap();
+        }
+        out.push_str("};\n");
+        write!(
+            out,
+            "extern const {} ExtensionHashTable[{}] = {{",
+            hash_table_type(extensions),
+            hash.table.len()
+        )
+        .unwrap();
+        for (n, index) in hash.table.iter().enumerate() {
+            if n != 0 {
+                out.push_str(", ");
+            }
+            write!(out, "{}", index).unwrap();
+        }
+        out.push_str("};\n");
     }
     out.push_str("}\n}\n");
     out
 }
 
+/// Build the perfect hash table for extension names.
+fn extension_hash(extensions: &[String]) -> PerfectHash {
+    let keys: Vec<&str> = extensions.iter().map(String::as_str).collect();
+    PerfectHash::build(&keys)
+}
+
+/// Get the C++ type for entries in the extension hash table. Entries are the
+/// extension index plus one, with zero for empty slots.
+fn hash_table_type(extensions: &[String]) -> &'static str {
+    if extensions.len() <= 0xff {
+        "unsigned char"
+    } else {
+        "unsigned short"
+    }
+}
+
 struct TypeMap(HashMap<&'static str, &'static str>);
 
 impl TypeMap {
@@ -0,0 +1,183 @@
+use std::collections::{HashMap, HashSet};
+
+/// Hash a string, for lookup in a perfect hash table. This is 32-bit FNV-1a,
+/// starting from the seed instead of the usual offset basis. This must match
+/// Hash32 in hash.hpp.
+pub fn hash(seed: u32, text: &[u8]) -> u32 {
+    let mut state = seed;
+    for &c in text.iter() {
+        state = (state ^ u32::from(c)).wrapping_mul(0x01000193);
+    }
+    state
+}
+
+/// Get the table slot for a hash, given the displacement for its bucket. This
+/// must match PerfectHashSlot in hash.hpp.
+fn slot(hash: u32, displacement: u32, bits: u32) -> usize {
+    ((hash ^ displacement).wrapping_mul(0x9e3779b9) >> (32 - bits)) as usize
+}
+
+/// Number of displacements to try for a bucket before picking a new seed.
+const DISPLACEMENT_ATTEMPTS: u32 = 1 << 16;
+
+/// A perfect hash table for a fixed set of strings, using hash and displace.
+/// Each string is hashed once. The top bits of the hash pick a bucket, and the
+/// bucket's displacement is mixed into the hash to pick the slot. Each string
+/// gets a different slot, so a lookup needs one hash and one comparison.
+///
+/// The comparison can be against the full hash instead of the string, if the
+/// table is built so that no other string which might be looked up has the
+/// same hash as one of the keys.
+#[derive(Debug)]
+pub struct PerfectHash {
+    pub seed: u32,
+    /// The table has 2^bits slots.
+    pub bits: u32,
+    /// There are 2^bucket_bits buckets.
+    pub bucket_bits: u32,
+    /// Displacement for each bucket.
+    pub displacements: Vec<u32>,
+    /// Index of the string in each slot, plus one. Empty slots are zero.
+    pub table: Vec<u32>,
+}
+
+impl PerfectHash {
+    /// Find a perfect hash for the given strings, which must be distinct.
+    pub fn build(keys: &[&str]) -> Self {
+        Self::build_avoiding(keys, &[])
+    }
+
+    /// Find a perfect hash for the given strings, with a seed that gives each
+    /// key a different hash from every string in the avoid list. The avoid
+    /// list may contain the keys themselves.
+    pub fn build_avoiding(keys: &[&str], avoid: &[&str]) -> Self {
+        // At least as many slots as keys, and about four keys per bucket.
+        let mut bits: u32 = 1;
+        while (1usize << bits) < keys.len() {
+            bits += 1;
+        }
+        let bucket_bits = bits.saturating_sub(2).max(1);
+        let key_set: HashSet<&str> = keys.iter().copied().collect();
+        let mut seed: u32 = 0x811c9dc5;
+        loop {
+            if !Self::has_collision(&key_set, avoid, seed) {
+                if let Some(hash) = Self::try_build(keys, seed, bits, bucket_bits) {
+                    return hash;
+                }
+            }
+            seed = seed.wrapping_add(0x9e3779b9);
+        }
+    }
+
+    /// Return true if any key has the same hash as another key or a string in
+    /// the avoid list.
+    fn has_collision(keys: &HashSet<&str>, avoid: &[&str], seed: u32) -> bool {
+        let mut hashes = HashMap::with_capacity(keys.len());
+        for &key in keys.iter() {
+            if hashes.insert(hash(seed, key.as_bytes()), key).is_some() {
+                return true;
+            }
+        }
+        avoid
+            .iter()
+            .any(|&text| match hashes.get(&hash(seed, text.as_bytes())) {
+                Some(&key) => key != text,
+                None => false,
+            })
+    }
+
+    fn try_build(keys: &[&str], seed: u32, bits: u32, bucket_bits: u32) -> Option<Self> {
+        let hashes: Vec<u32> = keys.iter().map(|k| hash(seed, k.as_bytes())).collect();
+        let mut buckets: Vec<Vec<usize>> = vec![Vec::new(); 1 << bucket_bits];
+        for (n, &h) in hashes.iter().enumerate() {
+            buckets[(h >> (32 - bucket_bits)) as usize].push(n);
+        }
+        // Place the largest buckets first, while the table is mostly empty.
+        let mut order: Vec<usize> = (0..buckets.len()).collect();
+        order.sort_by_key(|&b| std::cmp::Reverse(buckets[b].len()));
+        let mut displacements = vec![0; buckets.len()];
+        let mut table = vec![0; 1 << bits];
+        let mut slots = Vec::new();
+        for bucket in order {
+            let members = &buckets[bucket];
+            if members.is_empty() {
+                break;
+            }
+            let displacement = (0..DISPLACEMENT_ATTEMPTS).find(|&d| {
+                slots.clear();
+                for &n in members.iter() {
+                    let s = slot(hashes[n], d, bits);
+                    if table[s] != 0 || slots.contains(&s) {
+                        return false;
+                    }
+                    slots.push(s);
+                }
+                true
+            })?;
+            displacements[bucket] = displacement;
+            for (&n, &s) in members.iter().zip(slots.iter()) {
+                table[s] = n as u32 + 1;
+            }
+        }
+        Some(PerfectHash {
+            seed,
+            bits,
+            bucket_bits,
+            displacements,
+            table,
+        })
+    }
+
+    /// Get the index of a string in the table, if present.
+    #[cfg(test)]
+    fn lookup(&self, keys: &[&str], key: &str) -> Option<usize> {
+        let h = hash(self.seed, key.as_bytes());
+        let displacement = self.displacements[(h >> (32 - self.bucket_bits)) as usize];
+        let index = (self.table[slot(h, displacement, self.bits)] as usize).checked_sub(1)?;
+        if keys[index] == key {
+            Some(index)
+        } else {
+            None
+        }
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_hash() {
+        // Standard FNV-1a test vectors, using the offset basis as the seed.
+        assert_eq!(hash(0x811c9dc5, b""), 0x811c9dc5);
+        assert_eq!(hash(0x811c9dc5, b"a"), 0xe40c292c);
+        assert_eq!(hash(0x811c9dc5, b"foobar"), 0xbf9cf968);
+    }
+
+    #[test]
+    fn test_avoid() {
+        let names: Vec<String> = (0..2000).map(|n| format!("glFunction{}", n)).collect();
+        let all: Vec<&str> = names.iter().map(String::as_str).collect();
+        let keys = &all[..100];
+        let table = PerfectHash::build_avoiding(keys, &all);
+        for &other in all[100..].iter() {
+            let h = hash(table.seed, other.as_bytes());
+            assert!(keys.iter().all(|key| hash(table.seed, key.as_bytes()) != h));
+        }
+    }
+
+    #[test]
+    fn test_perfect_hash() {
+        let names: Vec<String> = (0..600).map(|n| format!("GL_EXT_test_{}", n)).collect();
+        let keys: Vec<&str> = names.iter().map(String::as_str).collect();
+        for count in [0, 1, 2, 3, 17, 300, 600] {
+            let keys = &keys[..count];
+            let table = PerfectHash::build(keys);
+            assert!(table.table.len() >= count);
+            for (n, key) in keys.iter().enumerate() {
+                assert_eq!(table.lookup(keys, key), Some(n));
+            }
+            assert_eq!(table.lookup(keys, "GL_ARB_missing"), None);
+        }
+    }
+}
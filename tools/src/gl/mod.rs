@@ -1,2 +1,4 @@
 pub mod api;
+pub mod hash;
 pub mod scan;
+pub mod trace;
@@ -0,0 +1,330 @@
+/// How a function argument is recorded in a trace and passed on replay.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum Arg {
+    /// A plain value, such as an integer or enum.
+    Value,
+    /// A pointer parameter which is really an offset into a bound buffer,
+    /// like the indices for glDrawElements. Recorded as an integer.
+    Offset,
+    /// Input data. Contains a C++ expression for its size in bytes.
+    Data(String),
+    /// A null-terminated string.
+    String,
+    /// An array of strings. Contains the name of the parameter with the
+    /// string count and the name of the parameter with the lengths, if any.
+    Strings(String, Option<String>),
+    /// String lengths for a preceding Strings argument. Not recorded. The
+    /// replayer passes the lengths of the recorded strings.
+    StringLengths,
+    /// Output pointer. Not recorded. The replayer passes a scratch buffer.
+    Output,
+}
+
+/// Sizes of input data which cannot be inferred from parameter types.
+/// Function name, parameter name, and a C++ expression for the size in bytes.
+/// Pixel data is assumed to come from client memory, not a pixel unpack
+/// buffer.
+const DATA_SIZES: &[(&str, &str, &str)] = &[
+    ("glBufferData", "data", "size"),
+    ("glBufferSubData", "data", "size"),
+    ("glProgramBinary", "binary", "length"),
+    ("glCompressedTexImage1D", "data", "imageSize"),
+    ("glCompressedTexImage2D", "data", "imageSize"),
+    ("glCompressedTexImage3D", "data", "imageSize"),
+    ("glCompressedTexSubImage1D", "data", "imageSize"),
+    ("glCompressedTexSubImage2D", "data", "imageSize"),
+    ("glCompressedTexSubImage3D", "data", "imageSize"),
+    (
+        "glTexImage1D",
+        "pixels",
+        "gl_trace::ImageSize(width, 1, 1, format, type)",
+    ),
+    (
+        "glTexImage2D",
+        "pixels",
+        "gl_trace::ImageSize(width, height, 1, format, type)",
+    ),
+    (
+        "glTexImage3D",
+        "pixels",
+        "gl_trace::ImageSize(width, height, depth, format, type)",
+    ),
+    (
+        "glTexSubImage1D",
+        "pixels",
+        "gl_trace::ImageSize(width, 1, 1, format, type)",
+    ),
+    (
+        "glTexSubImage2D",
+        "pixels",
+        "gl_trace::ImageSize(width, height, 1, format, type)",
+    ),
+    (
+        "glTexSubImage3D",
+        "pixels",
+        "gl_trace::ImageSize(width, height, depth, format, type)",
+    ),
+    (
+        "glClearBufferfv",
+        "value",
+        "gl_trace::ClearBufferCount(buffer) * sizeof(float)",
+    ),
+    (
+        "glClearBufferiv",
+        "value",
+        "gl_trace::ClearBufferCount(buffer) * sizeof(int)",
+    ),
+    (
+        "glClearBufferuiv",
+        "value",
+        "gl_trace::ClearBufferCount(buffer) * sizeof(unsigned)",
+    ),
+];
+
+/// Parameter types which cannot be recorded.
+const UNSUPPORTED_TYPES: &[&str] = &["GLsync", "GLDEBUGPROC", "GLDEBUGPROCKHR"];
+
+/// Get the pointed-to type of an input pointer type, like "float" for
+/// "const float *". Returns None for void pointers.
+fn element_type(ty: &str) -> Option<&str> {
+    let element = ty.strip_prefix("const ")?.strip_suffix('*')?.trim();
+    if element == "void" || element.contains('*') {
+        None
+    } else {
+        Some(element)
+    }
+}
+
+/// Get the number of components per element for functions which take vector
+/// or matrix arguments, like 3 for glUniform3fv or 6 for glUniformMatrix2x3fv.
+fn vector_components(function: &str) -> Option<u32> {
+    let suffix = function
+        .strip_prefix("glUniform")
+        .or_else(|| function.strip_prefix("glProgramUniform"))
+        .or_else(|| function.strip_prefix("glVertexAttrib"))?;
+    if !suffix.ends_with('v') {
+        return None;
+    }
+    let (suffix, matrix) = match suffix.strip_prefix("Matrix") {
+        None => (suffix, false),
+        Some(rest) => (rest, true),
+    };
+    let mut digits = suffix.chars().filter_map(|c| c.to_digit(10));
+    let first = digits.next()?;
+    Some(if !matrix {
+        first
+    } else {
+        match suffix.as_bytes().get(1) {
+            Some(b'x') => first * digits.next()?,
+            _ => first * first,
+        }
+    })
+}
+
+/// Get the size expression for an input pointer parameter, if known.
+fn data_size(function: &str, parameters: &[(&str, &str)], ty: &str, name: &str) -> Option<String> {
+    for &(f, p, size) in DATA_SIZES.iter() {
+        if f == function && p == name {
+            return Some(size.to_string());
+        }
+    }
+    let element = element_type(ty)?;
+    // A parameter with the given name which holds a count.
+    let has = |n: &str| {
+        parameters
+            .iter()
+            .any(|&(ty, name)| name == n && !ty.contains('*'))
+    };
+    if let Some(components) = vector_components(function) {
+        return Some(if has("count") {
+            format!("count * {} * sizeof({})", components, element)
+        } else {
+            format!("{} * sizeof({})", components, element)
+        });
+    }
+    for count in ["n", "count", "drawcount"] {
+        if has(count) {
+            return Some(format!("{} * sizeof({})", count, element));
+        }
+    }
+    None
+}
+
+/// Decide how to record each parameter of a function. The parameters are
+/// given as (type, name) pairs. Returns None if calls to the function cannot
+/// be recorded, for example, because it takes a callback or returns a
+/// pointer to mapped memory.
+pub fn classify(
+    function: &str,
+    return_type: &str,
+    parameters: &[(&str, &str)],
+) -> Option<Vec<Arg>> {
+    if return_type.contains('*') || UNSUPPORTED_TYPES.contains(&return_type) {
+        return None;
+    }
+    let mut args = Vec::with_capacity(parameters.len());
+    let mut string_lengths: Option<&str> = None;
+    for &(ty, name) in parameters.iter() {
+        if UNSUPPORTED_TYPES.contains(&ty) {
+            return None;
+        }
+        let arg = if !ty.contains('*') {
+            Arg::Value
+        } else if !ty.starts_with("const") {
+            Arg::Output
+        } else if string_lengths == Some(name) {
+            Arg::StringLengths
+        } else if ty == "const void *" && matches!(name, "pointer" | "indices" | "indirect") {
+            Arg::Offset
+        } else if ty == "const char *" {
+            Arg::String
+        } else if ty == "const char *const*" {
+            if !parameters.iter().any(|&(_, name)| name == "count") {
+                return None;
+            }
+            let length = parameters
+                .iter()
+                .find(|&&(ty, name)| name == "length" && ty == "const int *")
+                .map(|&(_, name)| name);
+            string_lengths = length;
+            Arg::Strings("count".to_string(), length.map(str::to_string))
+        } else {
+            Arg::Data(data_size(function, parameters, ty, name)?)
+        };
+        args.push(arg);
+    }
+    Some(args)
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_vector_components() {
+        assert_eq!(vector_components("glUniform1fv"), Some(1));
+        assert_eq!(vector_components("glUniform3iv"), Some(3));
+        assert_eq!(vector_components("glUniformMatrix4fv"), Some(16));
+        assert_eq!(vector_components("glUniformMatrix2x3fv"), Some(6));
+        assert_eq!(vector_components("glVertexAttribI4uiv"), Some(4));
+        assert_eq!(vector_components("glUniform1f"), None);
+        assert_eq!(vector_components("glDrawArrays"), None);
+    }
+
+    #[test]
+    fn test_classify() {
+        use Arg::*;
+        assert_eq!(
+            classify(
+                "glBufferData",
+                "void",
+                &[
+                    ("GLenum", "target"),
+                    ("long long", "size"),
+                    ("const void *", "data"),
+                    ("GLenum", "usage")
+                ]
+            ),
+            Some(vec![Value, Value, Data("size".into()), Value])
+        );
+        assert_eq!(
+            classify(
+                "glShaderSource",
+                "void",
+                &[
+                    ("unsigned", "shader"),
+                    ("int", "count"),
+                    ("const char *const*", "string"),
+                    ("const int *", "length")
+                ]
+            ),
+            Some(vec![
+                Value,
+                Value,
+                Strings("count".into(), Some("length".into())),
+                StringLengths
+            ])
+        );
+        assert_eq!(
+            classify(
+                "glUniformMatrix4fv",
+                "void",
+                &[
+                    ("int", "location"),
+                    ("int", "count"),
+                    ("unsigned char", "transpose"),
+                    ("const float *", "value")
+                ]
+            ),
+            Some(vec![
+                Value,
+                Value,
+                Value,
+                Data("count * 16 * sizeof(float)".into())
+            ])
+        );
+        assert_eq!(
+            classify(
+                "glDrawElements",
+                "void",
+                &[
+                    ("GLenum", "mode"),
+                    ("int", "count"),
+                    ("GLenum", "type"),
+                    ("const void *", "indices")
+                ]
+            ),
+            Some(vec![Value, Value, Value, Offset])
+        );
+        assert_eq!(
+            classify(
+                "glGenBuffers",
+                "void",
+                &[("int", "n"), ("unsigned *", "buffers")]
+            ),
+            Some(vec![Value, Output])
+        );
+        assert_eq!(
+            classify(
+                "glDeleteBuffers",
+                "void",
+                &[("int", "n"), ("const unsigned *", "buffers")]
+            ),
+            Some(vec![Value, Data("n * sizeof(unsigned)".into())])
+        );
+        assert_eq!(
+            classify(
+                "glMultiDrawArrays",
+                "void",
+                &[
+                    ("GLenum", "mode"),
+                    ("const int *", "first"),
+                    ("const int *", "count"),
+                    ("int", "drawcount")
+                ]
+            ),
+            Some(vec![
+                Value,
+                Data("drawcount * sizeof(int)".into()),
+                Data("drawcount * sizeof(int)".into()),
+                Value
+            ])
+        );
+        assert_eq!(
+            classify(
+                "glMapBuffer",
+                "void *",
+                &[("GLenum", "target"), ("GLenum", "access")]
+            ),
+            None
+        );
+        assert_eq!(
+            classify(
+                "glDebugMessageCallback",
+                "void",
+                &[("GLDEBUGPROC", "callback"), ("const void *", "userParam")]
+            ),
+            None
+        );
+    }
+}
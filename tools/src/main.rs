@@ -1,6 +1,7 @@
 use clap::Parser;
 use std::process;
 
+mod binlog;
 mod command;
 mod emit;
 mod error;
@@ -163,6 +163,10 @@ struct GLAPI {
     api: api::APISpec,
     link: api::APISpec,
     config: Option<Config>,
+    lazy: bool,
+    profile: bool,
+    trace: bool,
+    name_hashes: bool,
     source: ProjectPath,
     header: ProjectPath,
 }
@@ -172,6 +176,10 @@ impl GLAPI {
         let api: api::APISpec = params.property("api").parse()?.required()?;
         let link: api::APISpec = params.property("link").parse()?.required()?;
         let config: Option<Config> = params.property("config").parse()?.value;
+        let lazy: Option<bool> = params.property("lazy").parse()?.value;
+        let profile: Option<bool> = params.property("profile").parse()?.value;
+        let trace: Option<bool> = params.property("trace").parse()?.value;
+        let name_hashes: Option<bool> = params.property("name-hashes").parse()?.value;
         let source = params.output(SourceType::Source)?;
         let header = params.output(SourceType::Header)?;
         params.done()?;
@@ -179,6 +187,10 @@ impl GLAPI {
             api,
             link,
             config,
+            lazy: lazy.unwrap_or(false),
+            profile: profile.unwrap_or(false),
+            trace: trace.unwrap_or(false),
+            name_hashes: name_hashes.unwrap_or(false),
             source,
             header,
         })
@@ -192,8 +204,15 @@ impl Generator for GLAPI {
         sources: &SourceSpec,
     ) -> Result<Vec<Output>, Box<dyn error::Error>> {
         let api = api::API::create(&self.api, &self.link)?;
+        let options = api::Options {
+            lazy: self.lazy,
+            profile: self.profile,
+            trace: self.trace,
+            name_hashes: self.name_hashes,
+        };
+        options.validate()?;
         let bindings = match &self.config {
-            None => api.make_bindings(),
+            None => api.make_bindings(&options),
             Some(config) => {
                 let sources = sources.sources_for_config(config)?;
                 let mut flat_sources = Vec::new();
@@ -203,7 +222,7 @@ impl Generator for GLAPI {
                     }
                 }
                 let entry_points = scan::read_entrypoints(&flat_sources)?;
-                api.make_subset_bindings(&entry_points)?
+                api.make_subset_bindings(&entry_points, &options)?
             }
         };
         Ok(vec![
@@ -226,14 +245,22 @@ impl Generator for GLAPI {
 /// OpenGL shader bundler.
 #[derive(Debug)]
 struct GLShaders {
+    minify: bool,
     source: ProjectPath,
+    header: ProjectPath,
 }
 
 impl GLShaders {
     fn evaluate(mut params: Parameters) -> Result<Self, EvaluationError> {
+        let minify: Option<bool> = params.property("minify").parse()?.value;
         let source = params.output(SourceType::Source)?;
+        let header = params.output(SourceType::Header)?;
         params.done()?;
-        Ok(Self { source })
+        Ok(Self {
+            minify: minify.unwrap_or(false),
+            source,
+            header,
+        })
     }
 }
 
@@ -256,11 +283,21 @@ impl Generator for GLShaders {
             }
         };
         let manifest = spec.to_manifest();
-        let data = shader::Data::read_raw(&manifest, &directory)?;
+        let mut data = shader::Data::read_raw(&manifest, &directory)?;
+        if self.minify {
+            data.minify()?;
+        }
         let text = data.emit_text()?;
-        Ok(vec![Output {
-            path: self.source.clone(),
-            data: text.into(),
-        }])
+        let header = data.emit_header();
+        Ok(vec![
+            Output {
+                path: self.header.clone(),
+                data: header.into(),
+            },
+            Output {
+                path: self.source.clone(),
+                data: text.into(),
+            },
+        ])
     }
 }
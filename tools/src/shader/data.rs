@@ -1,10 +1,14 @@
-use super::spec::Manifest;
+use super::glsl;
+use super::minify;
+use super::spec::{Manifest, Program, ShaderType};
 use crate::emit;
+use crate::error::FileError;
+use std::collections::HashMap;
 use std::error;
 use std::fmt::{self, Write};
 use std::fs;
-use std::io;
 use std::path::{Path, PathBuf};
+use std::sync::Arc;
 
 /// Code generation error.
 #[derive(Debug, Clone, Copy)]
@@ -22,71 +26,484 @@ impl fmt::Display for EmitError {
 
 impl error::Error for EmitError {}
 
+/// Invalid include directive.
+#[derive(Debug, Clone)]
+pub struct IncludeError(String);
+
+impl fmt::Display for IncludeError {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        write!(f, "invalid include directive: {:?}", self.0)
+    }
+}
+
+impl error::Error for IncludeError {}
+
+/// Parse a line of source code. If it is an include directive, return the
+/// name of the included file.
+fn parse_include(line: &str) -> Result<Option<&str>, IncludeError> {
+    let directive = match line.trim_ascii_start().strip_prefix('#') {
+        None => return Ok(None),
+        Some(rest) => rest.trim_ascii_start(),
+    };
+    let Some(rest) = directive.strip_prefix("include") else {
+        return Ok(None);
+    };
+    match rest
+        .trim_ascii()
+        .strip_prefix('"')
+        .and_then(|name| name.strip_suffix('"'))
+    {
+        Some(name) if !name.is_empty() && !name.contains('"') => Ok(Some(name)),
+        _ => Err(IncludeError(line.to_string())),
+    }
+}
+
 /// An individual shader.
 #[derive(Debug, Clone)]
 pub struct Shader {
-    text: String,
+    name: Arc<str>,
+    /// Indexes of the chunks of source code, in order.
+    chunks: Vec<usize>,
+    interface: glsl::Interface,
+}
+
+/// Reads shader source code and splits it into chunks at include directives.
+/// Identical chunks are only stored once. The #version line is its own chunk,
+/// since it is the same for most shaders.
+struct Reader<'a> {
+    directory: &'a Path,
+    chunks: Vec<String>,
+    chunk_index: HashMap<String, usize>,
 }
 
-impl Shader {
-    /// Read shader source code from a file.
-    pub fn read_raw(path: &Path) -> Result<Self, io::Error> {
-        let raw_text = fs::read_to_string(path)?;
+impl<'a> Reader<'a> {
+    fn new(directory: &'a Path) -> Self {
+        Reader {
+            directory,
+            chunks: Vec::new(),
+            chunk_index: HashMap::new(),
+        }
+    }
+
+    /// Add a chunk of source code, if it is not empty, and clear the buffer.
+    fn flush(&mut self, text: &mut String, out: &mut Vec<usize>) {
+        let chunk = text.trim_start_matches('\n').trim_ascii_end();
+        if !chunk.is_empty() {
+            let chunk = format!("{}\n", chunk);
+            let index = match self.chunk_index.get(&chunk) {
+                Some(&index) => index,
+                None => {
+                    let index = self.chunks.len();
+                    self.chunks.push(chunk.clone());
+                    self.chunk_index.insert(chunk, index);
+                    index
+                }
+            };
+            out.push(index);
+        }
+        text.clear();
+    }
+
+    /// Read a shader or included file, and append its chunks to the list.
+    /// Included files are relative to the shader directory, and each file is
+    /// only included once per shader.
+    fn read(
+        &mut self,
+        name: &str,
+        included: &mut Vec<String>,
+        out: &mut Vec<usize>,
+    ) -> Result<(), FileError> {
+        let mut path = PathBuf::from(self.directory);
+        path.push(Path::new(name));
+        let raw_text = match fs::read_to_string(&path) {
+            Ok(text) => text,
+            Err(error) => {
+                return Err(FileError {
+                    path,
+                    error: Box::new(error),
+                });
+            }
+        };
         let mut text = String::with_capacity(raw_text.len() + 1);
         for line in raw_text.lines() {
-            text.push_str(line.trim_ascii_end());
-            text.push('\n');
+            let line = line.trim_ascii_end();
+            let include = match parse_include(line) {
+                Ok(include) => include,
+                Err(error) => {
+                    return Err(FileError {
+                        path,
+                        error: Box::new(error),
+                    });
+                }
+            };
+            match include {
+                Some(include) => {
+                    self.flush(&mut text, out);
+                    if !included.iter().any(|s| s == include) {
+                        included.push(include.to_string());
+                        self.read(include, included, out)?;
+                    }
+                }
+                None => {
+                    text.push_str(line);
+                    text.push('\n');
+                    if line.starts_with("#version") {
+                        self.flush(&mut text, out);
+                    }
+                }
+            }
         }
-        text.truncate(text.trim_ascii_end().len());
-        Ok(Shader { text })
+        self.flush(&mut text, out);
+        Ok(())
+    }
+
+    /// Read a shader and its included files.
+    fn read_shader(&mut self, name: &Arc<str>, ty: ShaderType) -> Result<Shader, FileError> {
+        let mut chunks = Vec::new();
+        self.read(name, &mut vec![name.to_string()], &mut chunks)?;
+        let text: String = chunks.iter().map(|&n| self.chunks[n].as_str()).collect();
+        let interface = match glsl::tokenize(&text)
+            .map_err(Box::<dyn error::Error>::from)
+            .and_then(|tokens| Ok(glsl::reflect(&tokens, ty)?))
+        {
+            Ok(interface) => interface,
+            Err(error) => {
+                return Err(FileError {
+                    path: self.directory.join(Path::new(name.as_ref())),
+                    error,
+                });
+            }
+        };
+        Ok(Shader {
+            name: name.clone(),
+            chunks,
+            interface,
+        })
     }
 }
 
 /// Collection of shader data that can be embedded in the ddemo.
 #[derive(Debug, Clone)]
 pub struct Data {
+    /// Chunks of shader source code, without duplicates.
+    chunks: Vec<String>,
     shaders: Vec<Shader>,
+    vertex_count: usize,
+    programs: Vec<Program<usize>>,
+}
+
+/// Write a table of null-separated strings, as a C array with the given name.
+fn emit_string_table<'a>(out: &mut String, name: &str, items: impl Iterator<Item = &'a [u8]>) {
+    let items: Vec<&[u8]> = items.collect();
+    let size = items.iter().map(|s| s.len()).sum::<usize>() + items.len();
+    write!(out, "extern const char {}[{}] =\n", name, size.max(1)).unwrap();
+    let mut writer = emit::StringWriter::new(out);
+    for (n, item) in items.iter().enumerate() {
+        if n != 0 {
+            writer.write(&[0]);
+        }
+        writer.write(item);
+    }
+    writer.finish();
+    out.push_str(";\n");
 }
 
 impl Data {
     /// Read raw shader data.
-    pub fn read_raw(manifest: &Manifest, directory: &Path) -> io::Result<Self> {
+    pub fn read_raw(manifest: &Manifest, directory: &Path) -> Result<Self, FileError> {
+        let mut reader = Reader::new(directory);
         let mut shaders = Vec::with_capacity(manifest.shaders.len());
         for shader in manifest.shaders.iter() {
-            let mut path = PathBuf::from(directory);
-            path.push(Path::new(shader.name.as_ref()));
-            shaders.push(Shader::read_raw(&path)?);
+            shaders.push(reader.read_shader(&shader.name, shader.ty)?);
+        }
+        let vertex_count = manifest
+            .shaders
+            .iter()
+            .filter(|s| s.ty == ShaderType::Vertex)
+            .count();
+        Ok(Data {
+            chunks: reader.chunks,
+            shaders,
+            vertex_count,
+            programs: manifest.programs.clone(),
+        })
+    }
+
+    /// Minify the source code for all shaders.
+    pub fn minify(&mut self) -> Result<(), glsl::LexError> {
+        let output = {
+            let mut tokens = Vec::with_capacity(self.chunks.len());
+            for chunk in self.chunks.iter() {
+                tokens.push(glsl::tokenize(chunk)?);
+            }
+            let chunks: Vec<&[glsl::Token]> = tokens.iter().map(Vec::as_slice).collect();
+            let mut varyings: Vec<&str> = Vec::new();
+            for shader in self.shaders.iter() {
+                for name in shader.interface.varyings.iter() {
+                    if !varyings.contains(&name.as_str()) {
+                        varyings.push(name);
+                    }
+                }
+            }
+            minify::minify(&chunks, &varyings)
+        };
+        self.chunks = output;
+        Ok(())
+    }
+
+    /// Get the uniforms used by a program, in order, without duplicates.
+    fn program_uniforms(&self, program: &Program<usize>) -> Vec<&str> {
+        let mut uniforms: Vec<&str> = Vec::new();
+        for shader in [program.vertex, program.fragment] {
+            for name in self.shaders[shader].interface.uniforms.iter() {
+                if !uniforms.contains(&name.as_str()) {
+                    uniforms.push(name);
+                }
+            }
         }
-        Ok(Data { shaders })
+        uniforms
     }
 
+    /// Emit the C++ header, with program IDs, uniform IDs, and attribute
+    /// locations.
+    pub fn emit_header(&self) -> String {
+        let program_uniform_counts: Vec<usize> = self
+            .programs
+            .iter()
+            .map(|p| self.program_uniforms(p).len())
+            .collect();
+        let uniform_count: usize = program_uniform_counts.iter().sum();
+        let feature_count: usize = self.programs.iter().map(|p| p.features.len()).sum();
+
+        let mut output = String::new();
+        output.push_str(emit::HEADER);
+        output.push_str(
+            "#pragma once\n\
+            #include <array>\n\
+            namespace demo {\n\
+            namespace gl_shader {\n",
+        );
+        write!(
+            output,
+            "constexpr int ShaderCount = {};\n\
+            constexpr int VertexShaderCount = {};\n\
+            constexpr int ChunkCount = {};\n\
+            constexpr int MaxShaderChunks = {};\n\
+            constexpr int ProgramCount = {};\n\
+            constexpr int UniformCount = {};\n\
+            constexpr int MaxProgramUniforms = {};\n\
+            constexpr int FeatureCount = {};\n",
+            self.shaders.len(),
+            self.vertex_count,
+            self.chunks.len(),
+            self.shaders
+                .iter()
+                .map(|s| s.chunks.len())
+                .max()
+                .unwrap_or(0),
+            self.programs.len(),
+            uniform_count,
+            program_uniform_counts.iter().copied().max().unwrap_or(0),
+            feature_count
+        )
+        .unwrap();
+
+        // Tables used by the loader. The chunks for shader N are
+        // ShaderChunks[ShaderChunkOffsets[N]] up to
+        // ShaderChunks[ShaderChunkOffsets[N+1]].
+        let chunk_list: Vec<usize> = self
+            .shaders
+            .iter()
+            .flat_map(|s| s.chunks.iter().copied())
+            .collect();
+        write!(
+            output,
+            "constexpr std::array<unsigned short, {}> ShaderChunks = {{{{",
+            chunk_list.len()
+        )
+        .unwrap();
+        for (n, index) in chunk_list.iter().enumerate() {
+            if n != 0 {
+                output.push_str(", ");
+            }
+            write!(output, "{}", index).unwrap();
+        }
+        output.push_str(
+            "}};\n\
+            constexpr std::array<unsigned short, ShaderCount + 1> ShaderChunkOffsets = {{0",
+        );
+        let mut offset = 0;
+        for shader in self.shaders.iter() {
+            offset += shader.chunks.len();
+            write!(output, ", {}", offset).unwrap();
+        }
+        output.push_str("}};\n");
+        output.push_str("constexpr std::array<ProgramSpec, ProgramCount> ProgramSpecs = {{\n");
+        for program in self.programs.iter() {
+            write!(output, "{{{}, {}}},\n", program.vertex, program.fragment).unwrap();
+        }
+        output.push_str(
+            "}};\n\
+            constexpr std::array<unsigned char, UniformCount> UniformPrograms = {{",
+        );
+        let mut first = true;
+        for (n, program) in self.programs.iter().enumerate() {
+            for _ in self.program_uniforms(program) {
+                if !first {
+                    output.push_str(", ");
+                }
+                first = false;
+                write!(output, "{}", n).unwrap();
+            }
+        }
+        output.push_str("}};\n");
+
+        // The uniforms and features for program N are the ones from offset N
+        // up to offset N+1.
+        output.push_str(
+            "constexpr std::array<unsigned short, ProgramCount + 1> \
+            ProgramUniformOffsets = {{0",
+        );
+        let mut offset = 0;
+        for count in program_uniform_counts.iter() {
+            offset += count;
+            write!(output, ", {}", offset).unwrap();
+        }
+        output.push_str(
+            "}};\n\
+            constexpr std::array<unsigned short, ProgramCount + 1> \
+            ProgramFeatureOffsets = {{0",
+        );
+        let mut offset = 0;
+        for program in self.programs.iter() {
+            offset += program.features.len();
+            write!(output, ", {}", offset).unwrap();
+        }
+        output.push_str(
+            "}};\n\
+            constexpr std::array<Feature, FeatureCount> FeatureSpecs = {{",
+        );
+        let mut first = true;
+        for program in self.programs.iter() {
+            let mut shift = 0;
+            for feature in program.features.iter() {
+                if !first {
+                    output.push_str(", ");
+                }
+                first = false;
+                write!(output, "{{{}, {}}}", shift, feature.bits()).unwrap();
+                shift += feature.bits();
+            }
+        }
+        output.push_str("}};\n");
+
+        // IDs for each program.
+        let mut uniform_id = 0;
+        for (n, program) in self.programs.iter().enumerate() {
+            write!(
+                output,
+                "// {}: {}, {}\n\
+                namespace {} {{\n\
+                constexpr int Program = {};\n",
+                program.name,
+                self.shaders[program.vertex].name,
+                self.shaders[program.fragment].name,
+                program.name,
+                n
+            )
+            .unwrap();
+            let uniforms = self.program_uniforms(program);
+            if !uniforms.is_empty() {
+                output.push_str("namespace uniform {\n");
+                for name in uniforms {
+                    write!(output, "constexpr int {} = {};\n", name, uniform_id).unwrap();
+                    uniform_id += 1;
+                }
+                output.push_str("}\n");
+            }
+            if !program.features.is_empty() {
+                output.push_str("namespace feature {\n");
+                let mut shift = 0;
+                for feature in program.features.iter() {
+                    write!(
+                        output,
+                        "constexpr Feature {}{{{}, {}}};\n",
+                        feature.name,
+                        shift,
+                        feature.bits()
+                    )
+                    .unwrap();
+                    shift += feature.bits();
+                }
+                output.push_str("}\n");
+            }
+            let attributes = &self.shaders[program.vertex].interface.attributes;
+            if !attributes.is_empty() {
+                output.push_str("namespace attrib {\n");
+                for attribute in attributes.iter() {
+                    write!(
+                        output,
+                        "constexpr int {} = {};\n",
+                        attribute.name, attribute.location
+                    )
+                    .unwrap();
+                }
+                output.push_str("}\n");
+            }
+            output.push_str("}\n");
+        }
+
+        output.push_str("}\n}\n");
+        output
+    }
+
+    /// Emit the C++ source file, with shader source code and names.
     pub fn emit_text(&self) -> Result<String, EmitError> {
-        // Null bytes are used to separate shaders, so they cannot be in the
+        // Null bytes are used to separate chunks, so they cannot be in the
         // shader sources.
-        if self.shaders.iter().any(|s| s.text.contains('\0')) {
+        if self.chunks.iter().any(|s| s.contains('\0')) {
             return Err(EmitError::NullByte);
         }
 
-        // Get size, including null bytes.
-        let size: usize =
-            self.shaders.iter().map(|s| s.text.len()).sum::<usize>() + self.shaders.len();
-
         let mut output = String::new();
         // Header.
         output.push_str(emit::HEADER);
         output.push_str("namespace demo {\nnamespace gl_shader {\n");
 
-        // Shader text.
-        write!(output, "extern const char ShaderText[{}] =\n", size).unwrap();
-        let mut writer = emit::StringWriter::new(&mut output);
-        for (n, shader) in self.shaders.iter().enumerate() {
-            if n != 0 {
-                writer.write(&[0]);
-            }
-            writer.write(shader.text.as_bytes());
+        // Shader text, one entry per chunk.
+        emit_string_table(
+            &mut output,
+            "ShaderText",
+            self.chunks.iter().map(|s| s.as_bytes()),
+        );
+
+        // Shader filenames, for loading shaders from the project directory.
+        emit_string_table(
+            &mut output,
+            "ShaderNames",
+            self.shaders.iter().map(|s| s.name.as_bytes()),
+        );
+
+        // Uniform names, in order of uniform ID.
+        let mut uniforms: Vec<&str> = Vec::new();
+        for program in self.programs.iter() {
+            uniforms.extend(self.program_uniforms(program));
         }
-        writer.finish();
-        output.push_str(";\n");
+        emit_string_table(
+            &mut output,
+            "UniformNames",
+            uniforms.iter().map(|s| s.as_bytes()),
+        );
+
+        // Feature names, in the same order as FeatureSpecs.
+        emit_string_table(
+            &mut output,
+            "FeatureNames",
+            self.programs
+                .iter()
+                .flat_map(|p| p.features.iter())
+                .map(|f| f.name.as_bytes()),
+        );
 
         // Footer.
         output.push_str("}\n}\n");
@@ -94,3 +511,24 @@ impl Data {
         Ok(output)
     }
 }
+
+#[cfg(test)]
+mod test {
+    use super::parse_include;
+
+    #[test]
+    fn test_parse_include() {
+        assert_eq!(parse_include("float x;").unwrap(), None);
+        assert_eq!(parse_include("#version 330").unwrap(), None);
+        assert_eq!(
+            parse_include("#include \"noise.glsl\"").unwrap(),
+            Some("noise.glsl")
+        );
+        assert_eq!(
+            parse_include("  #  include  \"sdf.glsl\"").unwrap(),
+            Some("sdf.glsl")
+        );
+        assert!(parse_include("#include <noise.glsl>").is_err());
+        assert!(parse_include("#include \"\"").is_err());
+    }
+}
@@ -0,0 +1,408 @@
+use super::spec::ShaderType;
+use std::error;
+use std::fmt;
+
+// ============================================================================
+// Lexer
+// ============================================================================
+
+/// A GLSL token.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Token<'a> {
+    /// Preprocessor directive. This is the entire line, without the newline.
+    Directive(&'a str),
+    Identifier(&'a str),
+    Number(&'a str),
+    Punct(&'a str),
+}
+
+/// Error tokenizing GLSL source code.
+#[derive(Debug, Clone, Copy)]
+pub enum LexError {
+    UnterminatedComment,
+    UnexpectedCharacter(char),
+}
+
+impl fmt::Display for LexError {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        match self {
+            LexError::UnterminatedComment => f.write_str("unterminated comment"),
+            LexError::UnexpectedCharacter(c) => write!(f, "unexpected character: {:?}", c),
+        }
+    }
+}
+
+impl error::Error for LexError {}
+
+/// Operators with more than one character, longest first.
+const OPERATORS: [&str; 22] = [
+    "<<=", ">>=", "++", "--", "&&", "||", "^^", "==", "!=", "<=", ">=", "+=", "-=", "*=", "/=",
+    "%=", "&=", "|=", "^=", "<<", ">>", "##",
+];
+
+fn is_identifier_start(c: u8) -> bool {
+    c.is_ascii_alphabetic() || c == b'_'
+}
+
+fn is_identifier_char(c: u8) -> bool {
+    c.is_ascii_alphanumeric() || c == b'_'
+}
+
+/// Split GLSL source code into tokens. Comments and whitespace are discarded.
+pub fn tokenize(text: &str) -> Result<Vec<Token<'_>>, LexError> {
+    let bytes = text.as_bytes();
+    let mut tokens = Vec::new();
+    let mut pos = 0;
+    // True if only whitespace appears between the start of the line and pos.
+    let mut line_start = true;
+    while pos < bytes.len() {
+        let c = bytes[pos];
+        let start = pos;
+        if c == b'\n' {
+            line_start = true;
+            pos += 1;
+            continue;
+        }
+        if c.is_ascii_whitespace() {
+            pos += 1;
+            continue;
+        }
+        if bytes[pos..].starts_with(b"//") {
+            while pos < bytes.len() && bytes[pos] != b'\n' {
+                pos += 1;
+            }
+            continue;
+        }
+        if bytes[pos..].starts_with(b"/*") {
+            match text[pos + 2..].find("*/") {
+                None => return Err(LexError::UnterminatedComment),
+                Some(end) => pos += end + 4,
+            }
+            continue;
+        }
+        if c == b'#' && line_start {
+            while pos < bytes.len() && bytes[pos] != b'\n' {
+                pos += 1;
+            }
+            tokens.push(Token::Directive(text[start..pos].trim_ascii_end()));
+            continue;
+        }
+        line_start = false;
+        if is_identifier_start(c) {
+            while pos < bytes.len() && is_identifier_char(bytes[pos]) {
+                pos += 1;
+            }
+            tokens.push(Token::Identifier(&text[start..pos]));
+        } else if c.is_ascii_digit()
+            || (c == b'.' && bytes.get(pos + 1).is_some_and(u8::is_ascii_digit))
+        {
+            // This is a "pp-number", which may contain an exponent sign.
+            pos += 1;
+            while pos < bytes.len() {
+                let c = bytes[pos];
+                if (c == b'+' || c == b'-') && matches!(bytes[pos - 1], b'e' | b'E') {
+                    pos += 1;
+                } else if is_identifier_char(c) || c == b'.' {
+                    pos += 1;
+                } else {
+                    break;
+                }
+            }
+            tokens.push(Token::Number(&text[start..pos]));
+        } else if c.is_ascii_punctuation() {
+            let len = OPERATORS
+                .iter()
+                .find(|op| bytes[pos..].starts_with(op.as_bytes()))
+                .map_or(1, |op| op.len());
+            pos += len;
+            tokens.push(Token::Punct(&text[start..pos]));
+        } else {
+            let c = text[pos..].chars().next().unwrap();
+            return Err(LexError::UnexpectedCharacter(c));
+        }
+    }
+    Ok(tokens)
+}
+
+// ============================================================================
+// Reflection
+// ============================================================================
+
+/// A vertex shader input with an explicit location.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Attribute {
+    pub name: String,
+    pub location: u32,
+}
+
+/// The interface to a shader: the uniforms, attributes, and varyings it
+/// declares. Varyings are vertex shader outputs and fragment shader inputs.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct Interface {
+    pub uniforms: Vec<String>,
+    pub attributes: Vec<Attribute>,
+    pub varyings: Vec<String>,
+}
+
+/// Error extracting the interface of a shader.
+#[derive(Debug, Clone)]
+pub enum ReflectError {
+    NoLocation(String),
+    InvalidLocation(String),
+    UniformBlock,
+    Syntax,
+}
+
+impl fmt::Display for ReflectError {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        match self {
+            ReflectError::NoLocation(name) => {
+                write!(f, "vertex input has no explicit location: {}", name)
+            }
+            ReflectError::InvalidLocation(text) => write!(f, "invalid location: {:?}", text),
+            ReflectError::UniformBlock => f.write_str("uniform blocks are not supported"),
+            ReflectError::Syntax => f.write_str("could not parse declaration"),
+        }
+    }
+}
+
+impl error::Error for ReflectError {}
+
+/// Storage and interpolation qualifiers which may appear before a type.
+const QUALIFIERS: [&str; 13] = [
+    "const",
+    "uniform",
+    "in",
+    "out",
+    "flat",
+    "smooth",
+    "noperspective",
+    "centroid",
+    "invariant",
+    "precise",
+    "highp",
+    "mediump",
+    "lowp",
+];
+
+/// Parse the contents of a layout qualifier, and return the location, if any.
+fn parse_layout(tokens: &[Token]) -> Result<Option<u32>, ReflectError> {
+    let mut location = None;
+    for (n, token) in tokens.iter().enumerate() {
+        if *token == Token::Identifier("location") {
+            location = match tokens.get(n + 1..n + 3) {
+                Some([Token::Punct("="), Token::Number(text)]) => Some(
+                    text.parse()
+                        .map_err(|_| ReflectError::InvalidLocation(text.to_string()))?,
+                ),
+                _ => return Err(ReflectError::Syntax),
+            };
+        }
+    }
+    Ok(location)
+}
+
+/// Parse a single top-level declaration, not including the semicolon.
+fn reflect_declaration(
+    tokens: &[Token],
+    ty: ShaderType,
+    interface: &mut Interface,
+) -> Result<(), ReflectError> {
+    let mut rest = tokens;
+    let mut location = None;
+    let mut is_uniform = false;
+    let mut is_input = false;
+    let mut is_output = false;
+    loop {
+        match rest {
+            [Token::Identifier("layout"), Token::Punct("("), tail @ ..] => {
+                let end = tail
+                    .iter()
+                    .position(|&t| t == Token::Punct(")"))
+                    .ok_or(ReflectError::Syntax)?;
+                location = parse_layout(&tail[..end])?;
+                rest = &tail[end + 1..];
+            }
+            [Token::Identifier(word), tail @ ..] if QUALIFIERS.contains(word) => {
+                match *word {
+                    "uniform" => is_uniform = true,
+                    "in" => is_input = true,
+                    "out" => is_output = true,
+                    _ => (),
+                }
+                rest = tail;
+            }
+            _ => break,
+        }
+    }
+    let is_attribute = is_input && ty == ShaderType::Vertex;
+    let is_varying = match ty {
+        ShaderType::Vertex => is_output,
+        ShaderType::Fragment => is_input,
+    };
+    if !is_uniform && !is_attribute && !is_varying {
+        return Ok(());
+    }
+    // Skip the type, then read a comma-separated list of declarators.
+    let mut declarators = match rest {
+        [Token::Identifier(_), tail @ ..] => tail,
+        _ => return Err(ReflectError::Syntax),
+    };
+    loop {
+        let name = match declarators {
+            [Token::Identifier(name), tail @ ..] => {
+                declarators = tail;
+                *name
+            }
+            _ => return Err(ReflectError::Syntax),
+        };
+        if is_uniform {
+            interface.uniforms.push(name.to_string());
+        } else if is_varying {
+            interface.varyings.push(name.to_string());
+        } else {
+            let location = location.ok_or_else(|| ReflectError::NoLocation(name.to_string()))?;
+            interface.attributes.push(Attribute {
+                name: name.to_string(),
+                location,
+            });
+        }
+        // Skip array size and initializer.
+        let mut depth = 0;
+        loop {
+            match declarators {
+                [] => return Ok(()),
+                [Token::Punct(","), tail @ ..] if depth == 0 => {
+                    declarators = tail;
+                    break;
+                }
+                [token, tail @ ..] => {
+                    match token {
+                        Token::Punct("(" | "[") => depth += 1,
+                        Token::Punct(")" | "]") => depth -= 1,
+                        _ => (),
+                    }
+                    declarators = tail;
+                }
+            }
+        }
+    }
+}
+
+/// Get the interface for a shader from its tokens. Attributes must have
+/// explicit locations, since the locations are used directly by C++ code.
+pub fn reflect(tokens: &[Token], ty: ShaderType) -> Result<Interface, ReflectError> {
+    let mut interface = Interface::default();
+    let mut start = 0;
+    let mut pos = 0;
+    while pos < tokens.len() {
+        match tokens[pos] {
+            Token::Directive(_) => {
+                start = pos + 1;
+            }
+            Token::Punct(";") => {
+                reflect_declaration(&tokens[start..pos], ty, &mut interface)?;
+                start = pos + 1;
+            }
+            Token::Punct("{") => {
+                if tokens[start..pos].contains(&Token::Identifier("uniform")) {
+                    return Err(ReflectError::UniformBlock);
+                }
+                // Skip function bodies and struct definitions.
+                let mut depth = 0;
+                while pos < tokens.len() {
+                    match tokens[pos] {
+                        Token::Punct("{") => depth += 1,
+                        Token::Punct("}") => {
+                            depth -= 1;
+                            if depth == 0 {
+                                break;
+                            }
+                        }
+                        _ => (),
+                    }
+                    pos += 1;
+                }
+                start = pos + 1;
+            }
+            _ => (),
+        }
+        pos += 1;
+    }
+    Ok(interface)
+}
+
+#[cfg(test)]
+mod test {
+    use super::{Attribute, Interface, ReflectError, Token, reflect, tokenize};
+    use crate::shader::spec::ShaderType;
+
+    fn check_reflect(text: &str, ty: ShaderType, expected: Interface) {
+        let tokens = tokenize(text).expect("Tokenizing should succeed.");
+        let result = reflect(&tokens, ty).expect("Reflection should succeed.");
+        assert_eq!(result, expected);
+    }
+
+    #[test]
+    fn test_tokenize() {
+        let tokens = tokenize("#version 330\nx+=1.5e-3; // c\n/* c */y>>=2").unwrap();
+        assert_eq!(
+            tokens,
+            vec![
+                Token::Directive("#version 330"),
+                Token::Identifier("x"),
+                Token::Punct("+="),
+                Token::Number("1.5e-3"),
+                Token::Punct(";"),
+                Token::Identifier("y"),
+                Token::Punct(">>="),
+                Token::Number("2"),
+            ]
+        );
+    }
+
+    #[test]
+    fn test_reflect() {
+        check_reflect(
+            "#version 330\n\
+            layout(location = 0) in vec3 Vertex;\n\
+            layout(location = 2) in vec4 Color;\n\
+            uniform mat4 MVP;\n\
+            uniform highp vec4 A[2], B;\n\
+            out vec4 vColor;\n\
+            struct S { float x; };\n\
+            void main() { vColor = Color; }\n",
+            ShaderType::Vertex,
+            Interface {
+                uniforms: vec!["MVP".into(), "A".into(), "B".into()],
+                varyings: vec!["vColor".into()],
+                attributes: vec![
+                    Attribute {
+                        name: "Vertex".into(),
+                        location: 0,
+                    },
+                    Attribute {
+                        name: "Color".into(),
+                        location: 2,
+                    },
+                ],
+            },
+        );
+        check_reflect(
+            "precision lowp float;\nin vec4 vColor;\nuniform float T;\n",
+            ShaderType::Fragment,
+            Interface {
+                uniforms: vec!["T".into()],
+                attributes: vec![],
+                varyings: vec!["vColor".into()],
+            },
+        );
+    }
+
+    #[test]
+    fn test_reflect_no_location() {
+        let tokens = tokenize("in vec3 Vertex;").unwrap();
+        let result = reflect(&tokens, ShaderType::Vertex);
+        assert!(matches!(result, Err(ReflectError::NoLocation(_))));
+    }
+}
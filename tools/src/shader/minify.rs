@@ -0,0 +1,495 @@
+use super::glsl::Token;
+use std::collections::{HashMap, HashSet};
+
+/// Reserved words short enough to collide with generated names. Longer
+/// keywords do not need to be listed, since generated names are short.
+const RESERVED: [&str; 22] = [
+    "as", "do", "if", "in", "asm", "for", "int", "out", "bool", "case", "cast", "else", "enum",
+    "flat", "goto", "half", "long", "lowp", "this", "true", "uint", "void",
+];
+
+/// Characters which may start a generated name.
+const NAME_START: &[u8] = b"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/// Characters which may appear after the start of a generated name.
+const NAME_REST: &[u8] = b"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+
+/// Qualifiers which make a global declaration part of the shader interface.
+const INTERFACE_QUALIFIERS: [&str; 4] = ["uniform", "in", "out", "inout"];
+
+/// Return true if the name is a built-in GLSL type.
+fn is_builtin_type(name: &str) -> bool {
+    if matches!(
+        name,
+        "void" | "bool" | "int" | "uint" | "float" | "double" | "atomic_uint"
+    ) {
+        return true;
+    }
+    if name.contains("sampler") || name.contains("image") {
+        return true;
+    }
+    let vector = name.trim_start_matches(['b', 'i', 'u', 'd']);
+    if matches!(vector, "vec2" | "vec3" | "vec4") {
+        return true;
+    }
+    let matrix = name.strip_prefix('d').unwrap_or(name);
+    match matrix.strip_prefix("mat") {
+        None => false,
+        Some(size) => {
+            let size = size.as_bytes();
+            match size {
+                [a] => (b'2'..=b'4').contains(a),
+                [a, b'x', b] => (b'2'..=b'4').contains(a) && (b'2'..=b'4').contains(b),
+                _ => false,
+            }
+        }
+    }
+}
+
+fn is_word_char(c: u8) -> bool {
+    c.is_ascii_alphanumeric() || c == b'_'
+}
+
+/// Get the identifiers in a preprocessor directive.
+fn directive_identifiers(text: &str) -> impl Iterator<Item = &str> {
+    text.split(|c: char| !c.is_ascii_alphanumeric() && c != '_')
+        .filter(|word| {
+            word.as_bytes()
+                .first()
+                .is_some_and(|&c| !c.is_ascii_digit())
+        })
+}
+
+/// Generates short identifiers, in order of length.
+struct NameGenerator {
+    counter: usize,
+}
+
+impl NameGenerator {
+    fn new() -> Self {
+        NameGenerator { counter: 0 }
+    }
+
+    /// Get the next name which is not reserved and not taken.
+    fn next(&mut self, taken: impl Fn(&str) -> bool) -> String {
+        loop {
+            let mut n = self.counter;
+            self.counter += 1;
+            let mut name = String::new();
+            name.push(char::from(NAME_START[n % NAME_START.len()]));
+            n /= NAME_START.len();
+            while n > 0 {
+                n -= 1;
+                name.push(char::from(NAME_REST[n % NAME_REST.len()]));
+                n /= NAME_REST.len();
+            }
+            if RESERVED.contains(&name.as_str())
+                || is_builtin_type(&name)
+                || name.starts_with("gl_")
+                || name.contains("__")
+                || taken(&name)
+            {
+                continue;
+            }
+            return name;
+        }
+    }
+}
+
+/// Identifiers in a chunk of source code, sorted into names which can be
+/// renamed and names which cannot.
+struct Analysis<'a> {
+    /// Names declared by the chunk which are not part of its interface, with
+    /// the number of times each is used.
+    declared: HashMap<&'a str, usize>,
+    /// Declared names at the top level. These may be used by other chunks.
+    globals: HashSet<&'a str>,
+    /// Names used but not declared by the chunk, with the number of times each
+    /// is used. These are built-in names, interface names, varyings, and names
+    /// declared in other chunks.
+    used: HashMap<&'a str, usize>,
+    /// Names which must not be renamed anywhere: struct fields and any name
+    /// which appears in a preprocessor directive.
+    fixed: HashSet<&'a str>,
+}
+
+/// Find the names declared by a chunk of source code.
+fn analyze<'a>(tokens: &[Token<'a>]) -> Analysis<'a> {
+    let mut declared: HashSet<&'a str> = HashSet::new();
+    let mut globals: HashSet<&'a str> = HashSet::new();
+    let mut fixed: HashSet<&'a str> = HashSet::new();
+    let mut struct_types: HashSet<&'a str> = HashSet::new();
+    // Nesting depth of parentheses and brackets, and of braces.
+    let mut depth: usize = 0;
+    let mut braces: usize = 0;
+    let mut statement_start = 0;
+    // Depth of the declaration being parsed, and whether it is part of the
+    // interface. Used for declarations with multiple names, like "float a, b".
+    let mut declaration: Option<(usize, bool)> = None;
+    let is_type = |name: &str, struct_types: &HashSet<&str>| {
+        is_builtin_type(name) || struct_types.contains(name)
+    };
+    let mut pos = 0;
+    while pos < tokens.len() {
+        match tokens[pos] {
+            Token::Directive(text) => {
+                fixed.extend(directive_identifiers(text));
+                statement_start = pos + 1;
+            }
+            Token::Identifier("struct") => {
+                // Struct fields are accessed after a period, and names after a
+                // period are never renamed. Don't rename anything in the
+                // struct definition.
+                if let Some(&Token::Identifier(name)) = tokens.get(pos + 1) {
+                    struct_types.insert(name);
+                }
+                let mut level = 0;
+                while pos < tokens.len() {
+                    match tokens[pos] {
+                        Token::Identifier(name) => {
+                            fixed.insert(name);
+                        }
+                        Token::Punct("{") => level += 1,
+                        Token::Punct("}") => {
+                            level -= 1;
+                            if level == 0 {
+                                break;
+                            }
+                        }
+                        _ => (),
+                    }
+                    pos += 1;
+                }
+                statement_start = pos + 1;
+            }
+            Token::Identifier(name) if is_type(name, &struct_types) => {
+                let after_period = pos > 0 && tokens[pos - 1] == Token::Punct(".");
+                if let (false, Some(&Token::Identifier(decl))) = (after_period, tokens.get(pos + 1))
+                {
+                    if !is_type(decl, &struct_types) {
+                        let is_function = tokens.get(pos + 2) == Some(&Token::Punct("("));
+                        let is_interface = braces == 0
+                            && depth == 0
+                            && !is_function
+                            && tokens[statement_start..pos].iter().any(|t| match t {
+                                Token::Identifier(q) => INTERFACE_QUALIFIERS.contains(q),
+                                _ => false,
+                            });
+                        if !is_interface && decl != "main" {
+                            declared.insert(decl);
+                            if braces == 0 && depth == 0 {
+                                globals.insert(decl);
+                            }
+                        }
+                        declaration = if is_function {
+                            None
+                        } else {
+                            Some((depth, is_interface))
+                        };
+                        pos += 2;
+                        continue;
+                    }
+                }
+            }
+            Token::Punct("(" | "[") => depth += 1,
+            Token::Punct(")" | "]") => {
+                depth = depth.saturating_sub(1);
+                if declaration.is_some_and(|(level, _)| depth < level) {
+                    declaration = None;
+                }
+            }
+            Token::Punct("{" | "}" | ";") => {
+                match tokens[pos] {
+                    Token::Punct("{") => braces += 1,
+                    Token::Punct("}") => braces = braces.saturating_sub(1),
+                    _ => (),
+                }
+                statement_start = pos + 1;
+                declaration = None;
+            }
+            Token::Punct(",") => {
+                if let Some((level, is_interface)) = declaration {
+                    if let (true, Some(&Token::Identifier(decl))) =
+                        (level == depth, tokens.get(pos + 1))
+                    {
+                        let next_is_name =
+                            matches!(tokens.get(pos + 2), Some(Token::Identifier(_)));
+                        if !next_is_name && !is_type(decl, &struct_types) {
+                            if !is_interface {
+                                declared.insert(decl);
+                                if braces == 0 && depth == 0 {
+                                    globals.insert(decl);
+                                }
+                            }
+                            pos += 2;
+                            continue;
+                        }
+                    }
+                }
+            }
+            _ => (),
+        }
+        pos += 1;
+    }
+
+    // Count uses. Names after a period are fields or swizzles, which are
+    // never renamed.
+    let mut counts: HashMap<&'a str, usize> = HashMap::new();
+    let mut used: HashMap<&'a str, usize> = HashMap::new();
+    for (n, token) in tokens.iter().enumerate() {
+        if let Token::Identifier(name) = *token {
+            if n > 0 && tokens[n - 1] == Token::Punct(".") {
+                fixed.insert(name);
+            } else if declared.contains(name) {
+                *counts.entry(name).or_default() += 1;
+            } else {
+                *used.entry(name).or_default() += 1;
+            }
+        }
+    }
+    // A name can be both declared and fixed, for example, a local variable
+    // with the same name as a struct field.
+    counts.retain(|name, _| !fixed.contains(name));
+    globals.retain(|name| !fixed.contains(name));
+    Analysis {
+        declared: counts,
+        globals,
+        used,
+        fixed,
+    }
+}
+
+/// Sort names so the most frequently used names come first.
+fn by_frequency<'a>(counts: &HashMap<&'a str, usize>) -> Vec<&'a str> {
+    let mut names: Vec<(&str, usize)> = counts.iter().map(|(&k, &v)| (k, v)).collect();
+    names.sort_by(|(xname, xcount), (yname, ycount)| {
+        ycount.cmp(xcount).then_with(|| xname.cmp(yname))
+    });
+    names.into_iter().map(|(name, _)| name).collect()
+}
+
+/// Shorten a floating-point literal, like "1.0" to "1." or "0.5" to ".5".
+fn shorten_number(text: &str) -> String {
+    let (int, frac) = match text.split_once('.') {
+        Some(parts) if !text.bytes().any(|c| c.is_ascii_alphabetic()) => parts,
+        _ => return text.to_string(),
+    };
+    let int = int.trim_start_matches('0');
+    let frac = frac.trim_end_matches('0');
+    if int.is_empty() && frac.is_empty() {
+        "0.".to_string()
+    } else {
+        format!("{}.{}", int, frac)
+    }
+}
+
+/// Return true if a space is needed between two tokens, so they are not
+/// parsed as a single token.
+fn needs_space(prev: &str, next: &str) -> bool {
+    let (Some(&a), Some(&b)) = (prev.as_bytes().last(), next.as_bytes().first()) else {
+        return false;
+    };
+    if is_word_char(a) && is_word_char(b) {
+        return true;
+    }
+    // A number like ".5" after a name or number.
+    if is_word_char(a) && b == b'.' && next.as_bytes().get(1).is_some_and(u8::is_ascii_digit) {
+        return true;
+    }
+    let pair = [a, b];
+    pair == *b"//"
+        || pair == *b"/*"
+        || matches!(
+            &pair,
+            b"++" | b"--" | b"&&" | b"||" | b"^^" | b"==" | b"<<" | b">>" | b"##"
+        )
+        || (b == b'=' && b"+-*/%&|^<>!=".contains(&a))
+}
+
+/// Write the tokens for a shader, renaming identifiers.
+fn emit(tokens: &[Token], names: &HashMap<&str, &str>) -> String {
+    let mut out = String::new();
+    // The previous token, if on the same line.
+    let mut prev = String::new();
+    for (n, token) in tokens.iter().enumerate() {
+        let text = match *token {
+            Token::Directive(text) => {
+                if !out.is_empty() && !out.ends_with('\n') {
+                    out.push('\n');
+                }
+                let text = match text.find("//") {
+                    None => text,
+                    Some(end) => &text[..end],
+                };
+                let words: Vec<&str> = text.split_ascii_whitespace().collect();
+                out.push_str(&words.join(" "));
+                out.push('\n');
+                prev.clear();
+                continue;
+            }
+            Token::Identifier(name) => {
+                if n > 0 && tokens[n - 1] == Token::Punct(".") {
+                    name.to_string()
+                } else {
+                    names.get(name).copied().unwrap_or(name).to_string()
+                }
+            }
+            Token::Number(text) => shorten_number(text),
+            Token::Punct(text) => text.to_string(),
+        };
+        if needs_space(&prev, &text) {
+            out.push(' ');
+        }
+        out.push_str(&text);
+        prev = text;
+    }
+    // Chunks are concatenated, so each ends with a newline in case the next
+    // chunk starts with a directive.
+    out.truncate(out.trim_ascii_end().len());
+    out.push('\n');
+    out
+}
+
+/// Minify shader source code, split into chunks. This removes comments and
+/// whitespace, shortens literals, and renames local variables, functions, and
+/// varyings.
+///
+/// Chunks may be shared between shaders, so global names and varyings are
+/// renamed the same way in every chunk. This way, a function declared in an
+/// included file can be called from any shader, and any vertex shader still
+/// links with any fragment shader. Local names are renamed per chunk.
+pub fn minify(chunks: &[&[Token]], varyings: &[&str]) -> Vec<String> {
+    let analyses: Vec<Analysis> = chunks.iter().map(|tokens| analyze(tokens)).collect();
+    let fixed: HashSet<&str> = analyses
+        .iter()
+        .flat_map(|a| a.fixed.iter().copied())
+        .collect();
+    let globals: HashSet<&str> = analyses
+        .iter()
+        .flat_map(|a| a.globals.iter().copied())
+        .chain(varyings.iter().copied())
+        .filter(|name| !fixed.contains(name))
+        .collect();
+
+    // Global names may not collide with any name in any chunk.
+    let mut global_counts: HashMap<&str, usize> = HashMap::new();
+    let mut taken: HashSet<&str> = fixed.clone();
+    for analysis in analyses.iter() {
+        for (&name, &count) in analysis.declared.iter().chain(analysis.used.iter()) {
+            if globals.contains(name) {
+                *global_counts.entry(name).or_default() += count;
+            } else if analysis.used.contains_key(name) {
+                taken.insert(name);
+            }
+        }
+    }
+    let mut generator = NameGenerator::new();
+    let mut global_names: HashMap<&str, String> = HashMap::new();
+    for name in by_frequency(&global_counts) {
+        global_names.insert(name, generator.next(|candidate| taken.contains(candidate)));
+    }
+
+    let mut output = Vec::with_capacity(chunks.len());
+    for (tokens, analysis) in chunks.iter().zip(analyses.iter()) {
+        let mut names: HashMap<&str, &str> = HashMap::new();
+        for (&name, new_name) in global_names.iter() {
+            names.insert(name, new_name);
+        }
+        let mut local_counts = analysis.declared.clone();
+        local_counts.retain(|name, _| !globals.contains(name) && !fixed.contains(name));
+        let mut generator = NameGenerator::new();
+        let mut locals: Vec<(&str, String)> = Vec::new();
+        for name in by_frequency(&local_counts) {
+            let new_name = generator.next(|candidate| {
+                analysis.fixed.contains(candidate)
+                    || analysis.used.contains_key(candidate)
+                    || global_names.values().any(|v| v == candidate)
+            });
+            locals.push((name, new_name));
+        }
+        for (name, new_name) in locals.iter() {
+            names.insert(name, new_name);
+        }
+        output.push(emit(tokens, &names));
+    }
+    output
+}
+
+#[cfg(test)]
+mod test {
+    use super::{minify, shorten_number};
+    use crate::shader::glsl::tokenize;
+
+    #[test]
+    fn test_shorten_number() {
+        assert_eq!(shorten_number("1.0"), "1.");
+        assert_eq!(shorten_number("0.5"), ".5");
+        assert_eq!(shorten_number("0.0"), "0.");
+        assert_eq!(shorten_number("10.250"), "10.25");
+        assert_eq!(shorten_number("1.0e3"), "1.0e3");
+        assert_eq!(shorten_number("100"), "100");
+    }
+
+    #[test]
+    fn test_minify() {
+        let vertex = "#version 330\n\
+            layout(location = 0) in vec3 Vertex;\n\
+            uniform mat4 MVP;\n\
+            out vec4 vColor;\n\
+            // Comment.\n\
+            float scale(float value, float amount) {\n\
+            \treturn value * amount;\n\
+            }\n\
+            void main() {\n\
+            \tfloat height = scale(Vertex.y, 0.5), width = 1.0;\n\
+            \tgl_Position = MVP * vec4(Vertex.x * width, height, Vertex.z, 1.0);\n\
+            \tvColor = vec4(height - -1.0);\n\
+            }\n";
+        let fragment = "#version 330\n\
+            in vec4 vColor;\n\
+            out vec4 FragColor;\n\
+            void main() {\n\
+            \tFragColor = vColor;\n\
+            }\n";
+        let vertex_tokens = tokenize(vertex).unwrap();
+        let fragment_tokens = tokenize(fragment).unwrap();
+        let output = minify(&[&vertex_tokens, &fragment_tokens], &["vColor"]);
+        assert_eq!(
+            output[0],
+            "#version 330\n\
+            layout(location=0)in vec3 Vertex;uniform mat4 MVP;out vec4 a;\
+            float b(float e,float d){return e*d;}\
+            void main(){float c=b(Vertex.y,.5),f=1.;\
+            gl_Position=MVP*vec4(Vertex.x*f,c,Vertex.z,1.);a=vec4(c- -1.);}\n"
+        );
+        assert_eq!(
+            output[1],
+            "#version 330\n\
+            in vec4 a;out vec4 FragColor;void main(){FragColor=a;}\n"
+        );
+    }
+
+    #[test]
+    fn test_minify_chunks() {
+        // A library chunk, and a shader chunk which uses it.
+        let library = "float brightness(vec3 color) {\n\
+            \tfloat total = color.r + color.g + color.b;\n\
+            \treturn total / 3.0;\n\
+            }\n";
+        let shader = "void main() {\n\
+            \tfloat value = brightness(vec3(1.0));\n\
+            \tgl_FragColor = vec4(value);\n\
+            }\n";
+        let library_tokens = tokenize(library).unwrap();
+        let shader_tokens = tokenize(shader).unwrap();
+        let output = minify(&[&library_tokens, &shader_tokens], &[]);
+        assert_eq!(
+            output[0],
+            "float a(vec3 c){float d=c.r+c.g+c.b;return d/3.;}\n"
+        );
+        assert_eq!(
+            output[1],
+            "void main(){float b=a(vec3(1.));gl_FragColor=vec4(b);}\n"
+        );
+    }
+}
@@ -1,4 +1,6 @@
 mod data;
+mod glsl;
+mod minify;
 mod parse;
 mod spec;
 
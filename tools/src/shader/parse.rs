@@ -1,4 +1,4 @@
-use super::spec::{Program, ShaderType, Spec};
+use super::spec::{Feature, Program, ShaderType, Spec};
 use crate::intern;
 use std::path::Path;
 use std::sync::Arc;
@@ -7,21 +7,27 @@ use std::{error, fmt, fs, io};
 /// Kinds of parse errors.
 #[derive(Debug)]
 pub enum ErrorKind {
-    UnknownField(String),
     UnknownExtension(String),
     NoShader(ShaderType),
     ExtraShader(ShaderType),
+    InvalidFeature(String),
+    DuplicateFeature(String),
+    TooManyFeatures,
 }
 
 impl fmt::Display for ErrorKind {
     fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
         match self {
-            ErrorKind::UnknownField(text) => write!(f, "unknown field: {:?}", text),
             ErrorKind::UnknownExtension(ext) => write!(f, "unknown file extension: {:?}", ext),
             ErrorKind::NoShader(shader_type) => write!(f, "missing shader type: {:?}", shader_type),
             ErrorKind::ExtraShader(shader_type) => {
                 write!(f, "multiple shaders with same type: {:?}", shader_type)
             }
+            ErrorKind::InvalidFeature(text) => write!(f, "invalid feature: {:?}", text),
+            ErrorKind::DuplicateFeature(name) => write!(f, "duplicate feature: {:?}", name),
+            ErrorKind::TooManyFeatures => {
+                write!(f, "features do not fit in {} bits", MAX_FEATURE_BITS)
+            }
         }
     }
 }
@@ -33,6 +39,29 @@ pub struct Error {
     lineno: u32,
 }
 
+/// Maximum number of bits in a variant key.
+const MAX_FEATURE_BITS: u32 = 32;
+
+/// Parse a feature define, like "SHADOWS" or "SAMPLES=4".
+fn parse_feature(field: &str, strings: &mut intern::Table) -> Result<Feature, ErrorKind> {
+    let (name, max) = match field.split_once('=') {
+        None => (field, Some(1)),
+        Some((name, max)) => (name, max.parse::<u32>().ok().filter(|&n| n > 0)),
+    };
+    let valid_name = name
+        .bytes()
+        .next()
+        .is_some_and(|c| c.is_ascii_alphabetic() || c == b'_')
+        && name.bytes().all(|c| c.is_ascii_alphanumeric() || c == b'_');
+    match (valid_name, max) {
+        (true, Some(max)) => Ok(Feature {
+            name: strings.add(name),
+            max,
+        }),
+        _ => Err(ErrorKind::InvalidFeature(field.to_string())),
+    }
+}
+
 /// Parse a single line of program specs.
 fn parse_line(
     line: &str,
@@ -49,6 +78,7 @@ fn parse_line(
     };
     let mut vertex: Option<&str> = None;
     let mut fragment: Option<&str> = None;
+    let mut features: Vec<Feature> = Vec::new();
     for field in fields {
         if let Some((_, ext)) = field.rsplit_once('.') {
             let shader_type = match ShaderType::from_extension(ext) {
@@ -65,7 +95,14 @@ fn parse_line(
             *value = Some(field);
             continue;
         }
-        return Err(ErrorKind::UnknownField(field.to_string()));
+        let feature = parse_feature(field, strings)?;
+        if features.iter().any(|f| f.name == feature.name) {
+            return Err(ErrorKind::DuplicateFeature(feature.name.to_string()));
+        }
+        features.push(feature);
+    }
+    if features.iter().map(Feature::bits).sum::<u32>() > MAX_FEATURE_BITS {
+        return Err(ErrorKind::TooManyFeatures);
     }
     let vertex = vertex.ok_or(ErrorKind::NoShader(ShaderType::Vertex))?;
     let fragment = fragment.ok_or(ErrorKind::NoShader(ShaderType::Fragment))?;
@@ -73,6 +110,7 @@ fn parse_line(
         name: strings.add(name),
         vertex: strings.add(vertex),
         fragment: strings.add(fragment),
+        features,
     }))
 }
 
@@ -125,3 +163,30 @@ pub fn read_spec(path: &Path) -> Result<Spec, ReadError> {
     let text = fs::read_to_string(path)?;
     Ok(parse_spec(&text)?)
 }
+
+#[cfg(test)]
+mod test {
+    use super::{ErrorKind, parse_spec};
+
+    #[test]
+    fn test_parse_features() {
+        let spec = parse_spec("Cube cube.vert cube.frag SHADOWS SAMPLES=4\n").unwrap();
+        let features = &spec.programs[0].features;
+        assert_eq!(features.len(), 2);
+        assert_eq!(features[0].name.as_ref(), "SHADOWS");
+        assert_eq!(features[0].bits(), 1);
+        assert_eq!(features[1].name.as_ref(), "SAMPLES");
+        assert_eq!(features[1].bits(), 3);
+        for text in [
+            "A a.vert a.frag 1X",
+            "A a.vert a.frag X=0",
+            "A a.vert a.frag X X",
+        ] {
+            let error = parse_spec(text).unwrap_err();
+            assert!(matches!(
+                error.kind,
+                ErrorKind::InvalidFeature(_) | ErrorKind::DuplicateFeature(_)
+            ));
+        }
+    }
+}
@@ -12,6 +12,24 @@ pub struct Program<Shader> {
     pub vertex: Shader,
     /// Fragment shader source filename.
     pub fragment: Shader,
+    /// Feature defines, which select variants of the program at run-time.
+    pub features: Vec<Feature>,
+}
+
+/// A feature define for a shader program. Each variant of the program is
+/// compiled with a different value for the define, from 0 to the maximum.
+/// Boolean features have a maximum of 1.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Feature {
+    pub name: Arc<str>,
+    pub max: u32,
+}
+
+impl Feature {
+    /// Number of bits needed to store the feature value in a variant key.
+    pub fn bits(&self) -> u32 {
+        u32::BITS - self.max.leading_zeros()
+    }
 }
 
 /// A spec for all shader programs to compile and link.
@@ -36,9 +54,11 @@ impl Spec {
                 name: program.name.clone(),
                 vertex: vertex_shaders.add(&program.vertex),
                 fragment: fragment_shaders.add(&program.fragment),
+                features: program.features.clone(),
             });
         }
-        let fragment_offset = fragment_shaders.shaders.len();
+        // Fragment shaders come after all vertex shaders.
+        let fragment_offset = vertex_shaders.shaders.len();
         for program in programs.iter_mut() {
             program.fragment += fragment_offset;
         }
@@ -66,10 +86,14 @@ impl Spec {
         for (n, program) in self.programs.iter().enumerate() {
             write!(
                 &mut out,
-                "  {}: {}; {} {}\n",
+                "  {}: {}; {} {}",
                 n, program.name, program.vertex, program.fragment
             )
             .unwrap();
+            for feature in program.features.iter() {
+                write!(&mut out, " {}={}", feature.name, feature.max).unwrap();
+            }
+            out.push('\n');
         }
         out
     }